@@ -0,0 +1,74 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "casadi_blas.hpp"
+#include "global_options.hpp"
+
+#ifdef WITH_BLAS
+extern "C" {
+  void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+              const double* alpha, const double* a, const int* lda, const double* b,
+              const int* ldb, const double* beta, double* c, const int* ldc);
+  void dgemv_(const char* trans, const int* m, const int* n, const double* alpha,
+              const double* a, const int* lda, const double* x, const int* incx,
+              const double* beta, double* y, const int* incy);
+}
+#endif // WITH_BLAS
+
+namespace casadi {
+
+  template<>
+  bool casadi_blas_mtimes(const double* x, const Sparsity& sp_x,
+                          const double* y, const Sparsity& sp_y,
+                          double* z, const Sparsity& sp_z) {
+#ifdef WITH_BLAS
+    // Dimensions, z is m-by-n, x is m-by-k
+    int m = sp_z.size1(), n = sp_z.size2(), k = sp_x.size2();
+
+    // Only large, dense products
+    if (GlobalOptions::blas_threshold<0 || m==0 || n==0 || k==0) return false;
+    if (static_cast<double>(m)*n*k < GlobalOptions::blas_threshold) return false;
+    if (!sp_x.is_dense() || !sp_y.is_dense() || !sp_z.is_dense()) return false;
+
+    double one = 1;
+    int inc = 1;
+    if (n==1) {
+      // Matrix-vector product
+      dgemv_("N", &m, &k, &one, x, &m, y, &inc, &one, z, &inc);
+    } else if (m==1) {
+      // Vector-matrix product, z' += y'*x'
+      dgemv_("T", &k, &n, &one, y, &k, x, &inc, &one, z, &inc);
+    } else {
+      // Matrix-matrix product
+      dgemm_("N", "N", &m, &n, &k, &one, x, &m, y, &k, &one, z, &m);
+    }
+    return true;
+#else // WITH_BLAS
+    return false;
+#endif // WITH_BLAS
+  }
+
+} // namespace casadi
@@ -0,0 +1,58 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_CASADI_BLAS_HPP
+#define CASADI_CASADI_BLAS_HPP
+
+#include "sparsity.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Dense matrix product z += x*y through BLAS
+   *
+   * Returns false, leaving z untouched, unless CasADi was compiled with BLAS,
+   * all of x, y and z are dense and the number of multiply-adds reaches
+   * GlobalOptions::blas_threshold. The caller then falls back to casadi_mtimes.
+   */
+  template<typename T1>
+  bool casadi_blas_mtimes(const T1* x, const Sparsity& sp_x, const T1* y, const Sparsity& sp_y,
+                          T1* z, const Sparsity& sp_z) {
+    return false;
+  }
+
+  /// Specialization for double precision (dgemm/dgemv)
+  template<>
+  CASADI_EXPORT bool casadi_blas_mtimes(const double* x, const Sparsity& sp_x,
+                                        const double* y, const Sparsity& sp_y,
+                                        double* z, const Sparsity& sp_z);
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_CASADI_BLAS_HPP
@@ -42,6 +42,7 @@
 #include "mx/mx.hpp"
 
 // Functions
+#include "function/function_buffer.hpp"
 #include "function/code_generator.hpp"
 #include "function/importer.hpp"
 #include "function/callback.hpp"
@@ -26,6 +26,7 @@
 
 #include "code_generator.hpp"
 #include "function_internal.hpp"
+#include "../global_options.hpp"
 #include <iomanip>
 #include "casadi/core/runtime/runtime_embedded.hpp"
 
@@ -52,6 +53,11 @@ namespace casadi {
     this->codegen_scalars = false;
     this->with_header = false;
     this->with_mem = false;
+    this->blas = false;
+    this->max_chunk = 0;
+    this->split_files = false;
+    this->batch = false;
+    this->n_chunks_ = 0;
 
     // Read options
     for (auto&& e : opts) {
@@ -71,6 +77,14 @@ namespace casadi {
         this->with_header = e.second;
       } else if (e.first=="with_mem") {
         this->with_mem = e.second;
+      } else if (e.first=="blas") {
+        this->blas = e.second;
+      } else if (e.first=="max_chunk") {
+        this->max_chunk = e.second;
+      } else if (e.first=="split_files") {
+        this->split_files = e.second;
+      } else if (e.first=="batch") {
+        this->batch = e.second;
       } else {
         casadi_error("Unrecongnized option: " << e.first);
       }
@@ -127,6 +141,15 @@ namespace casadi {
     }
     f->generateMeta(*this, f.name());
     this->exposed_fname.push_back(f.name());
+
+    // Entry point evaluating several instances at once
+    if (this->batch && f->has_batch()) {
+      f->generateBatch(*this, f.name() + "_batch", false);
+      if (this->with_header) {
+        if (this->cpp) this->header << "extern \"C\" " ; // C linkage
+        this->header << f->batch_signature(f.name() + "_batch") << ";" << endl;
+      }
+    }
   }
 
   std::string CodeGenerator::dump() const {
@@ -180,6 +203,35 @@ namespace casadi {
     string fullname = prefix + this->name + this->suffix;
     file_open(s, fullname);
 
+    // Files with chunks of split algorithms
+    if (!chunk_bodies_.empty()) {
+      // Names relative to the directory of the main file
+      size_t sep = prefix.find_last_of('/');
+      string dir = sep==string::npos ? "" : prefix.substr(0, sep+1);
+      vector<string> files = chunk_files(prefix.substr(dir.size()));
+      s << "/*CASADIMETA" << endl << ":sources";
+      for (auto&& f : files) s << " " << f;
+      s << endl << "*/" << endl << endl;
+
+      for (int k=0; k<chunk_bodies_.size(); ++k) {
+        ofstream c;
+        file_open(c, dir + files[k]);
+
+        // Chunk functions are named as in the main file, auxiliaries are local to the file
+        c << "#ifdef CODEGEN_PREFIX" << endl
+          << "  #define NAMESPACE_CONCAT(NS, ID) _NAMESPACE_CONCAT(NS, ID)" << endl
+          << "  #define _NAMESPACE_CONCAT(NS, ID) NS ## ID" << endl
+          << "  #define CASADI_CHUNK(ID) NAMESPACE_CONCAT(CODEGEN_PREFIX, ID)" << endl
+          << "#else /* CODEGEN_PREFIX */" << endl
+          << "  #define CASADI_CHUNK(ID) " << this->name << "_ ## ID" << endl
+          << "#endif /* CODEGEN_PREFIX */" << endl
+          << "#define CASADI_PREFIX(ID) CASADI_CHUNK(chunk" << k << "_ ## ID)" << endl << endl;
+        dump_common(c);
+        c << chunk_bodies_[k] << endl;
+        file_close(c);
+      }
+    }
+
     // Generate the actual function
     dump(s);
 
@@ -283,6 +335,37 @@ namespace casadi {
          << "  #define CASADI_PREFIX(ID) " << this->name << "_ ## ID" << endl
          << "#endif /* CODEGEN_PREFIX */" << endl << endl;
 
+    // Everything up to the auxiliary functions
+    dump_common(s);
+
+    // Print integer constants
+    stringstream name;
+    for (int i=0; i<integer_constants_.size(); ++i) {
+      name.str(string());
+      name << "CASADI_PREFIX(s" << i << ")";
+      print_vector(s, name.str(), integer_constants_[i]);
+      s << "#define s" << i << " CASADI_PREFIX(s" << i << ")" << endl;
+    }
+
+    // Print double constants
+    for (int i=0; i<double_constants_.size(); ++i) {
+      name.str(string());
+      name << "CASADI_PREFIX(c" << i << ")";
+      print_vector(s, name.str(), double_constants_[i]);
+      s << "#define c" << i << " CASADI_PREFIX(c" << i << ")" << endl;
+    }
+
+    // Chunks of split algorithms
+    s << this->chunks.str();
+
+    // Codegen body
+    s << this->body.str();
+
+    // End with new line
+    s << endl;
+  }
+
+  void CodeGenerator::dump_common(std::ostream& s) const {
     s << this->includes.str();
     s << endl;
 
@@ -315,29 +398,6 @@ namespace casadi {
 
     // Codegen auxiliary functions
     s << this->auxiliaries.str();
-
-    // Print integer constants
-    stringstream name;
-    for (int i=0; i<integer_constants_.size(); ++i) {
-      name.str(string());
-      name << "CASADI_PREFIX(s" << i << ")";
-      print_vector(s, name.str(), integer_constants_[i]);
-      s << "#define s" << i << " CASADI_PREFIX(s" << i << ")" << endl;
-    }
-
-    // Print double constants
-    for (int i=0; i<double_constants_.size(); ++i) {
-      name.str(string());
-      name << "CASADI_PREFIX(c" << i << ")";
-      print_vector(s, name.str(), double_constants_[i]);
-      s << "#define c" << i << " CASADI_PREFIX(c" << i << ")" << endl;
-    }
-
-    // Codegen body
-    s << this->body.str();
-
-    // End with new line
-    s << endl;
   }
 
   std::string CodeGenerator::to_string(int n) {
@@ -611,6 +671,23 @@ namespace casadi {
         << codegen_str_mtimes_define
         << endl;
       break;
+    case AUX_BLAS_MTIMES:
+      this->auxiliaries
+        << "#ifdef __cplusplus" << endl
+        << "extern \"C\"" << endl
+        << "#endif" << endl
+        << "void dgemm_(const char* transa, const char* transb, const int* m, const int* n, "
+        << "const int* k, const double* alpha, const double* a, const int* lda, "
+        << "const double* b, const int* ldb, const double* beta, double* c, const int* ldc);"
+        << endl
+        << "void CASADI_PREFIX(blas_mtimes)(const real_t* x, const real_t* y, real_t* z, "
+        << "int m, int n, int k) {" << endl
+        << "  real_t one = 1;" << endl
+        << "  dgemm_(\"N\", \"N\", &m, &n, &k, &one, x, &m, y, &k, &one, z, &m);" << endl
+        << "}" << endl
+        << "#define blas_mtimes(x, y, z, m, n, k) CASADI_PREFIX(blas_mtimes)(x, y, z, m, n, k)"
+        << endl << endl;
+      break;
     case AUX_SQ:
       auxSq();
       break;
@@ -827,6 +904,28 @@ namespace casadi {
     return s.str();
   }
 
+  std::string CodeGenerator::add_chunk(const std::string& body) {
+    string sig = "(const real_t** arg, real_t** res, real_t* w)";
+    string id = "chunk" + to_string(n_chunks_++);
+    if (this->split_files) {
+      // Declare here, define in a separate file
+      this->chunks << "void CASADI_PREFIX(" << id << ")" << sig << ";" << endl << endl;
+      chunk_bodies_.push_back("void CASADI_CHUNK(" + id + ")" + sig + " {\n" + body + "}\n");
+    } else {
+      this->chunks << "static void CASADI_PREFIX(" << id << ")" << sig << " {" << endl
+                   << body << "}" << endl << endl;
+    }
+    return "CASADI_PREFIX(" + id + ")";
+  }
+
+  std::vector<std::string> CodeGenerator::chunk_files(const std::string& prefix) const {
+    vector<string> ret(chunk_bodies_.size());
+    for (int k=0; k<ret.size(); ++k) {
+      ret[k] = prefix + this->name + "_chunk" + to_string(k) + this->suffix;
+    }
+    return ret;
+  }
+
   std::string CodeGenerator::declare(std::string s) {
     // Add C linkage?
     if (this->cpp) {
@@ -921,10 +1020,26 @@ namespace casadi {
   }
 #endif // WITH_DEPRECATED_FEATURES
 
+  bool CodeGenerator::use_blas(int m, int n, int k) const {
+    return this->blas && GlobalOptions::blas_threshold>=0 && m>0 && n>0 && k>0
+      && static_cast<double>(m)*n*k >= GlobalOptions::blas_threshold;
+  }
+
   std::string CodeGenerator::mtimes(const std::string& x, const Sparsity& sp_x,
                                     const std::string& y, const Sparsity& sp_y,
                                     const std::string& z, const Sparsity& sp_z,
                                     const std::string& w, bool tr) {
+    // Large dense products through BLAS
+    int m = sp_z.size1(), n = sp_z.size2(), k = tr ? sp_x.size1() : sp_x.size2();
+    if (!tr && sp_x.is_dense() && sp_y.is_dense() && sp_z.is_dense() && use_blas(m, n, k)) {
+      casadi_assert_message(this->real_t=="double", "BLAS requires real_t double");
+      addAuxiliary(CodeGenerator::AUX_BLAS_MTIMES);
+      stringstream s;
+      s << "blas_mtimes(" << x << ", " << y << ", " << z << ", "
+        << m << ", " << n << ", " << k << ");";
+      return s.str();
+    }
+
     addAuxiliary(CodeGenerator::AUX_MTIMES);
     stringstream s;
     s << "mtimes(" << x << ", " << sparsity(sp_x) << ", " << y << ", " << sparsity(sp_y) << ", "
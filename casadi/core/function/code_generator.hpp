@@ -120,6 +120,9 @@ namespace casadi {
                        const std::string& z, const Sparsity& sp_z,
                        const std::string& w, bool tr);
 
+    /** \brief Is a dense product with dimensions m-by-k times k-by-n passed to BLAS? */
+    bool use_blas(int m, int n, int k) const;
+
     /** \brief Codegen bilinear form */
     std::string bilin(const std::string& A, const Sparsity& sp_A,
                       const std::string& x, const std::string& y);
@@ -131,6 +134,15 @@ namespace casadi {
     /** \brief Declare a function */
     std::string declare(std::string s);
 
+    /** \brief Add a chunk of a split algorithm
+        Defines a function <tt>void name(const real_t** arg, real_t** res, real_t* w)</tt>
+        with the given body, in a file of its own if split_files is set. Returns its name.
+    */
+    std::string add_chunk(const std::string& body);
+
+    /** \brief Names of the files holding the chunks, relative to the main file */
+    std::vector<std::string> chunk_files(const std::string& prefix="") const;
+
     /** \brief Auxiliary functions */
     enum Auxiliary {
       AUX_COPY,
@@ -148,6 +160,7 @@ namespace casadi {
       AUX_SQ,
       AUX_SIGN,
       AUX_MTIMES,
+      AUX_BLAS_MTIMES,
       AUX_PROJECT,
       AUX_TRANS,
       AUX_TO_MEX,
@@ -224,6 +237,9 @@ namespace casadi {
     // Generate main entry point
     void generate_main(std::ostream &s) const;
 
+    // Generate everything up to and including the auxiliary functions
+    void dump_common(std::ostream& s) const;
+
     /// SQUARE
     void auxSq();
 
@@ -264,12 +280,46 @@ namespace casadi {
      */
     bool codegen_scalars;
 
+    /** \brief Use BLAS for dense matrix products
+     * Products with at least GlobalOptions::blas_threshold multiply-adds
+     * call dgemm, which must then be linked with the generated code
+     */
+    bool blas;
+
+    /** \brief Maximum number of operations in one generated C function
+     * Larger SX algorithms are split into chunks, each a function of its own, with
+     * values that are live between chunks passed through the work vector. 0 (default):
+     * no splitting
+     */
+    int max_chunk;
+
+    /** \brief Write each chunk to a file of its own
+     * The files are listed in the meta data of the main file and compiled in parallel
+     * by the "shell" importer
+     */
+    bool split_files;
+
+    /** \brief Generate batched entry points
+     * For functions that support it, also generate <tt>fname_batch(arg, res, iw, w, n)</tt>,
+     * which evaluates n instances with the nonzeros stored structure-of-arrays: nonzero k
+     * of instance i at arg[j][k*n+i], likewise for res. The instances are evaluated in
+     * one SIMD-friendly loop
+     */
+    bool batch;
+
     // Stringstreams holding the different parts of the file being generated
     std::stringstream includes;
     std::stringstream auxiliaries;
     std::stringstream body;
     std::stringstream header;
 
+    // Chunk functions (or their declarations, if split_files)
+    std::stringstream chunks;
+
+    // Chunk functions written to separate files
+    std::vector<std::string> chunk_bodies_;
+    int n_chunks_;
+
     // Names of exposed functions
     std::vector<std::string> exposed_fname;
 
@@ -280,6 +330,7 @@ namespace casadi {
     std::set<Auxiliary> added_auxiliaries_;
     PointerMap added_sparsities_;
     PointerMap added_dependencies_;
+    PointerMap added_batch_;
     std::multimap<size_t, size_t> added_double_constants_;
     std::multimap<size_t, size_t> added_integer_constants_;
 
@@ -83,8 +83,11 @@ namespace casadi {
     // Hessian blocks
     std::vector<HBlock> hess_;
 
+    // Calculate Hessian blocks by edge pushing (SX only)
+    bool hessian_edge_pushing_;
+
     // Constructor
-    Factory(const Function::AuxOut& aux) : aux_(aux) {}
+    Factory(const Function::AuxOut& aux) : aux_(aux), hessian_edge_pushing_(false) {}
 
     // Add an input expression
     void add_input(const std::string& s, const MatType& e);
@@ -130,8 +133,14 @@ namespace casadi {
     // Get output scheme
     std::vector<std::string> name_out() const;
 
+    // Upper triangular part of a Hessian block
+    MatType hessian_triu(const MatType& ex, const MatType& arg) const;
   };
 
+  // Hessian blocks by edge pushing, defined in sx_function.cpp
+  template<>
+  SX Factory<SX>::hessian_triu(const SX& ex, const SX& arg) const;
+
   template<typename MatType>
   void Factory<MatType>::
   add_input(const std::string& s, const MatType& e) {
@@ -334,10 +343,15 @@ namespace casadi {
       casadi_assert_message(b.arg1==b.arg2, "Mixed Hessian terms not supported");
       const MatType& arg1 = in_.at(b.arg1);
       //const MatType& arg2 = in_.at(b.arg2);
-      out_["hess:" + b.ex + ":" + b.arg1 + ":" + b.arg2] = triu(hessian(ex, arg1));
+      out_["hess:" + b.ex + ":" + b.arg1 + ":" + b.arg2] = hessian_triu(ex, arg1);
     }
   }
 
+  template<typename MatType>
+  MatType Factory<MatType>::hessian_triu(const MatType& ex, const MatType& arg) const {
+    return triu(hessian(ex, arg));
+  }
+
   template<typename MatType>
   MatType Factory<MatType>::get_input(const std::string& s) {
     auto it = in_.find(s);
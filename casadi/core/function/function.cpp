@@ -364,8 +364,9 @@ namespace casadi {
     vector<int> iw(sz_iw());
     vector<D> w(sz_w());
 
-    // Evaluate memoryless
-    (*this)(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+    // Evaluate with a memory object of its own
+    ScopedCheckout mem(*this);
+    (*this)(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), mem);
   }
 
 
@@ -1438,6 +1439,20 @@ namespace casadi {
     (*this)->release(mem);
   }
 
+  ScopedCheckout::ScopedCheckout(const Function& f) : f_(f.operator->()) {
+    checked_out_ = f_->has_memory();
+    mem_ = checked_out_ ? f_->checkout() : 0;
+  }
+
+  ScopedCheckout::ScopedCheckout(const FunctionInternal* f) : f_(f) {
+    checked_out_ = f_->has_memory();
+    mem_ = checked_out_ ? f_->checkout() : 0;
+  }
+
+  ScopedCheckout::~ScopedCheckout() {
+    if (checked_out_) f_->release(mem_);
+  }
+
   void* Function::memory(int ind) const {
     return (*this)->memory(ind);
   }
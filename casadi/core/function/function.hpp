@@ -82,6 +82,19 @@ namespace casadi {
             implicitFunction, IDAS solver
       Further releases may disallow this.
 
+      THREAD SAFETY: When compiled with WITH_THREAD (default), a Function instance can be
+      evaluated concurrently from several threads. Every numerical evaluation checks out a
+      memory object of its own (see checkout/release and ScopedCheckout), also for functions
+      called from MX graphs, Map, Switch and the solvers in the core. This holds for SX and
+      MX functions, Map, Switch, the Newton rootfinder, sqpmethod, scpgen, the fixed step
+      integrators (rk, collocation) and linear solves (csparse, csparsecholesky, lapacklu,
+      lapackqr, symbolicqr) embedded in expressions.
+      Not safe for concurrent evaluation of the same instance are plugins that share a
+      linear solver between memory objects or keep state in the wrapped library: cvodes,
+      idas, kinsol, qpoases, slicot, blocksqp, snopt, worhp, knitro and the ma27 linear
+      solver; ipopt and bonmin are only as thread-safe as the linear solver they use.
+      Symbolic operations (creating expressions and functions) are not thread-safe.
+
       \internal
       \section Notes for developers
 
@@ -593,7 +606,7 @@ namespace casadi {
 #endif // WITH_DEPRECATED_FEATURES
 
     /** \brief  Evaluate symbolically in parallel and sum (matrix graph)
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used: unroll|serial|openmp|simd
     */
     std::vector<MX> mapsum(const std::vector<MX > &arg,
                            const std::string& parallelization="serial");
@@ -658,7 +671,7 @@ namespace casadi {
                 s_(N-1) <- f(a_(N-1), p_(N-1))
         \endverbatim
 
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used: unroll|serial|openmp|simd
     */
     Function map(int n, const std::string& parallelization="serial");
 
@@ -956,10 +969,10 @@ namespace casadi {
     /// Assert that an output dimension is equal so some given value
     void assert_size_out(int i, int nrow, int ncol) const;
 
-    /// Checkout a memory object
+    /// Checkout a memory object, thread-safe when compiled with WITH_THREAD
     int checkout() const;
 
-    /// Release a memory object
+    /// Release a memory object, thread-safe when compiled with WITH_THREAD
     void release(int mem) const;
 
 #ifndef SWIG
@@ -1022,6 +1035,39 @@ namespace casadi {
 #endif // SWIG
   };
 
+#ifndef SWIG
+  /** \brief Checks out a memory object of a function for the lifetime of the instance
+
+      Functions without memory objects (e.g. SX and MX functions) are evaluated with
+      memory object 0 and no checkout takes place. Otherwise a memory object that is
+      not in use by any other evaluation is taken from the function's pool and returned
+      to it on destruction, allowing concurrent evaluations from different threads.
+  */
+  class CASADI_EXPORT ScopedCheckout {
+  public:
+    ///@{
+    /// Constructor
+    explicit ScopedCheckout(const Function& f);
+    explicit ScopedCheckout(const FunctionInternal* f);
+    ///@}
+
+    /// Destructor, releases the memory object
+    ~ScopedCheckout();
+
+    /// Index of the memory object
+    operator int() const { return mem_;}
+
+  private:
+    // Not copyable
+    ScopedCheckout(const ScopedCheckout&);
+    ScopedCheckout& operator=(const ScopedCheckout&);
+
+    const FunctionInternal* f_;
+    int mem_;
+    bool checked_out_;
+  };
+#endif // SWIG
+
 } // namespace casadi
 
 #include "../matrix_impl.hpp"
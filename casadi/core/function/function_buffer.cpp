@@ -0,0 +1,68 @@
+
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "function_buffer.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  FunctionBuffer::FunctionBuffer(const Function& f) : f_(f) {
+    casadi_assert_message(!f.is_null(), "FunctionBuffer: null function");
+
+    // Input and output storage
+    offset_in_.resize(f.n_in()+1, 0);
+    for (int i=0; i<f.n_in(); ++i) offset_in_[i+1] = offset_in_[i] + f.nnz_in(i);
+    in_.resize(offset_in_.back(), 0);
+    offset_out_.resize(f.n_out()+1, 0);
+    for (int i=0; i<f.n_out(); ++i) offset_out_[i+1] = offset_out_[i] + f.nnz_out(i);
+    out_.resize(offset_out_.back(), 0);
+
+    // Work vectors
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    arg_.resize(sz_arg, 0);
+    res_.resize(sz_res, 0);
+    iw_.resize(sz_iw);
+    w_.resize(sz_w);
+
+    // Point to the internal storage
+    for (int i=0; i<f.n_in(); ++i) arg_[i] = input(i);
+    for (int i=0; i<f.n_out(); ++i) res_[i] = get_ptr(out_) + offset_out_[i];
+
+    // Memory object used exclusively by this buffer
+    mem_ = f.checkout();
+  }
+
+  FunctionBuffer::~FunctionBuffer() {
+    f_.release(mem_);
+  }
+
+  void FunctionBuffer::eval() {
+    f_(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), get_ptr(w_), mem_);
+  }
+
+} // namespace casadi
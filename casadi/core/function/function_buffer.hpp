@@ -0,0 +1,100 @@
+
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_FUNCTION_BUFFER_HPP
+#define CASADI_FUNCTION_BUFFER_HPP
+
+#include "function.hpp"
+
+#ifndef SWIG
+
+namespace casadi {
+
+  /** \brief Reusable context for numerical evaluation of a Function
+   *
+   * Allocates the work vectors and buffers for the inputs and outputs once,
+   * and checks out a memory object of the function, so that repeated
+   * evaluation with eval() does not allocate heap memory. The nonzeros of
+   * the inputs and outputs follow f.sparsity_in(i) and f.sparsity_out(i).
+   * Inputs and outputs can also be redirected to external storage.
+   *
+   * A buffer must not be used from more than one thread at a time, but
+   * different buffers of the same function can be evaluated concurrently if
+   * the function itself supports it.
+   */
+  class CASADI_EXPORT FunctionBuffer {
+  public:
+    /// Create a buffer for a function
+    explicit FunctionBuffer(const Function& f);
+
+    /// Release the memory object
+    ~FunctionBuffer();
+
+    /// Access the function
+    const Function& function() const { return f_;}
+
+    /// Nonzeros of input ind
+    double* input(int ind) { return get_ptr(in_) + offset_in_.at(ind);}
+
+    /// Nonzeros of output ind
+    const double* output(int ind) const { return get_ptr(out_) + offset_out_.at(ind);}
+
+    /// Read input ind from external storage, null means zero
+    void set_input(int ind, const double* a) { arg_.at(ind) = a;}
+
+    /// Write output ind to external storage, null means not calculated
+    void set_output(int ind, double* r) { res_.at(ind) = r;}
+
+    /// Evaluate the function
+    void eval();
+
+  private:
+    /// Not copyable, the memory object is owned by the buffer
+    FunctionBuffer(const FunctionBuffer&);
+    FunctionBuffer& operator=(const FunctionBuffer&);
+
+    // The function
+    Function f_;
+
+    // Memory object
+    int mem_;
+
+    // Storage for the nonzeros of the inputs and outputs
+    std::vector<double> in_, out_;
+    std::vector<int> offset_in_, offset_out_;
+
+    // Work vectors
+    std::vector<const double*> arg_;
+    std::vector<double*> res_;
+    std::vector<int> iw_;
+    std::vector<double> w_;
+  };
+
+} // namespace casadi
+
+#endif // SWIG
+
+#endif // CASADI_FUNCTION_BUFFER_HPP
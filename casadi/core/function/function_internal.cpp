@@ -28,14 +28,25 @@
 #include "../std_vector_tools.hpp"
 #include "../global_options.hpp"
 #include "external.hpp"
+#include "importer_internal.hpp"
+#include "../timing.hpp"
 
 #include <typeinfo>
 #include <cctype>
 #ifdef WITH_DL
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #endif // WITH_DL
 #include <iomanip>
+#include <atomic>
+#include <exception>
+#ifdef _WIN32
+#include <process.h>
+#else // _WIN32
+#include <unistd.h>
+#endif // _WIN32
 
 using namespace std;
 
@@ -73,6 +84,7 @@ namespace casadi {
     regularity_check_ = false;
     inputs_check_ = true;
     jit_ = false;
+    jit_async_ = false;
     compilerplugin_ = "clang";
 
     eval_ = 0;
@@ -88,13 +100,19 @@ namespace casadi {
     sz_res_per_ = 0;
     sz_iw_per_ = 0;
     sz_w_per_ = 0;
+
+    nmem_ = 0;
+    fill_n(mem_, sizeof(mem_)/sizeof(mem_[0]), static_cast<void**>(0));
   }
 
   FunctionInternal::~FunctionInternal() {
-    for (void* m : mem_) {
-      casadi_assert_warning(m==0, "Memory object has not been properly freed");
+    // Wait for a background compilation, which does not access this object
+    if (jit_thread_.joinable()) jit_thread_.join();
+
+    for (int i=0; i<nmem_; ++i) {
+      casadi_assert_warning(memory(i)==0, "Memory object has not been properly freed");
     }
-    mem_.clear();
+    for (auto&& b : mem_) delete[] b;
   }
 
   void FunctionInternal::construct(const Dict& opts) {
@@ -172,6 +190,15 @@ namespace casadi {
       {"jit_options",
        {OT_DICT,
         "Options to be passed to the jit compiler."}},
+      {"jit_codegen_options",
+       {OT_DICT,
+        "Options to be passed to the code generator when using the just-in-time compiler, "
+        "e.g. max_chunk and split_files to compile large functions in parts"}},
+      {"jit_async",
+       {OT_BOOL,
+        "Compile in a background thread and evaluate without the compiled code until it "
+        "is ready. The time of the switch is reported in the statistics. "
+        "Requires WITH_THREAD, otherwise compiles synchronously. Default: false"}},
       {"derivative_of",
        {OT_FUNCTION,
         "The function is a derivative of another function. "
@@ -214,6 +241,10 @@ namespace casadi {
         compilerplugin_ = op.second.to_string();
       } else if (op.first=="jit_options") {
         jit_options_ = op.second;
+      } else if (op.first=="jit_codegen_options") {
+        jit_codegen_options_ = op.second;
+      } else if (op.first=="jit_async") {
+        jit_async_ = op.second;
       } else if (op.first=="derivative_of") {
         derivative_of_ = op.second;
       } else if (op.first=="ad_weight") {
@@ -285,29 +316,123 @@ namespace casadi {
         if (verbose())
           log("FunctionInternal::finalize", "Codegenerating function '" + name() + "'.");
         // JIT everything
-        CodeGenerator gen(jit_name);
+        CodeGenerator gen(jit_name, jit_codegen_options_);
         gen.add(self());
         if (verbose())
           log("FunctionInternal::finalize", "Compiling function '" + name() + "'..");
-        compiler_ = Importer(gen.generate(), compilerplugin_, jit_options_);
-        if (verbose())
-          log("FunctionInternal::finalize", "Compiling function '" + name() + "' done.");
-        // Try to load with simplified syntax
-        simple_ = (simple_t)compiler_.get_function(name() + "_simple");
-        // If not succesful, try generic syntax
-        if (simple_==0) {
-          eval_ = (eval_t)compiler_.get_function(name());
-          casadi_assert_message(eval_!=0, "Cannot load JIT'ed function.");
+        // The file name is unique to the process and call, the contents only depend on the
+        // function, so that concurrent compilations do not interfere and cache keys match
+        static std::atomic<int> jit_counter(0);
+#ifdef _WIN32
+        int pid = _getpid();
+#else // _WIN32
+        int pid = getpid();
+#endif // _WIN32
+        stringstream jit_prefix;
+        jit_prefix << "tmp_casadi_" << pid << "_" << jit_counter++ << "_";
+        vector<string> jit_file = gen.chunk_files(jit_prefix.str());
+        jit_file.insert(jit_file.begin(), gen.generate(jit_prefix.str()));
+#ifdef WITH_THREAD
+        if (jit_async_) {
+          // Load the plugin here, the plugin registry is not thread-safe
+          ImporterInternal::getPlugin(compilerplugin_);
+          // The thread only works on copies and on the shared state, not on this object
+          auto st = std::make_shared<JitState>();
+          st->status = JIT_COMPILING;
+          st->simple = 0;
+          st->eval = 0;
+          st->t_switch = 0;
+          jit_state_ = st;
+          string plugin = compilerplugin_, fname = name();
+          Dict opts = jit_options_;
+          jit_thread_ = std::thread([st, jit_file, plugin, opts, fname]() {
+            FStats t;
+            t.tic();
+            try {
+              jit_compile(jit_file, plugin, opts, fname, st->compiler, st->simple, st->eval);
+              t.toc();
+              st->t_switch = t.t_wall;
+              st->status = JIT_READY;
+            } catch(exception& ex) {
+              st->error = ex.what();
+              st->status = JIT_FAILED;
+            } catch(...) {
+              // Nothing may escape the thread, that would call std::terminate
+              st->error = "Unknown exception";
+              st->status = JIT_FAILED;
+            }
+          });
+        } else {
+          jit_load(jit_file);
         }
+#else // WITH_THREAD
+        casadi_assert_warning(!jit_async_, "Option \"jit_async\" requires WITH_THREAD");
+        jit_load(jit_file);
+#endif // WITH_THREAD
       } else {
         // Just jit dependencies
         jit_dependencies(jit_name);
       }
     }
 
-    // Create memory object
+    // Create memory object 0, used by the first evaluation that checks out memory
     int mem = checkout();
     casadi_assert(mem==0);
+    release(mem);
+  }
+
+  void FunctionInternal::jit_compile(const std::vector<std::string>& jit_file,
+                                     const std::string& plugin, const Dict& opts,
+                                     const std::string& fname,
+                                     Importer& compiler, simple_t& simple, eval_t& eval) {
+    try {
+      compiler = Importer(jit_file.front(), plugin, opts);
+    } catch (...) {
+      for (auto&& f : jit_file) remove(f.c_str());
+      throw;
+    }
+    for (auto&& f : jit_file) remove(f.c_str());
+    // Try to load with simplified syntax, if not succesful, try generic syntax
+    simple = (simple_t)compiler.get_function(fname + "_simple");
+    eval = simple ? 0 : (eval_t)compiler.get_function(fname);
+    casadi_assert_message(simple!=0 || eval!=0, "Cannot load JIT'ed function.");
+  }
+
+  void FunctionInternal::jit_load(const std::vector<std::string>& jit_file) {
+    simple_t simple;
+    eval_t eval;
+    jit_compile(jit_file, compilerplugin_, jit_options_, name(), compiler_, simple, eval);
+    if (verbose())
+      log("FunctionInternal::jit_load", "Compiling function '" + name() + "' done.");
+    simple_ = simple;
+    eval_ = eval;
+  }
+
+  void FunctionInternal::jit_poll() {
+    // Acquires the fields written by the compiling thread
+    if (jit_state_->status!=JIT_READY) return;
+    simple_ = jit_state_->simple;
+    eval_ = jit_state_->eval;
+  }
+
+  Dict FunctionInternal::_get_stats(int mem) const {
+    Dict stats = get_stats(memory(mem));
+    if (!jit_state_) return stats;
+    switch (jit_state_->status) {
+    case JIT_COMPILING:
+      stats["jit_status"] = "compiling";
+      break;
+    case JIT_READY:
+      stats["jit_status"] = "ready";
+      stats["jit_t_switch"] = jit_state_->t_switch;
+      break;
+    case JIT_FAILED:
+      stats["jit_status"] = "failed";
+      stats["jit_error"] = jit_state_->error;
+      break;
+    default: break;
+    }
+    return stats;
   }
 
   void FunctionInternal::
@@ -320,6 +445,7 @@ namespace casadi {
       }
 
       // Evaluate
+      if (!simple_ && jit_state_) jit_poll();
       if (simple_) {
         simple_(arg1, w);
       } else {
@@ -332,6 +458,7 @@ namespace casadi {
         ++w;
       }
     } else {
+      if (!eval_ && jit_state_) jit_poll();
       if (eval_) {
         eval_(arg, res, iw, w, mem);
       } else {
@@ -412,6 +539,7 @@ namespace casadi {
     opts["jit"] = jit_;
     opts["compiler"] = compilerplugin_;
     opts["jit_options"] = jit_options_;
+    opts["jit_codegen_options"] = jit_codegen_options_;
     return opts;
   }
 
@@ -514,9 +642,39 @@ namespace casadi {
 
   /// \cond INTERNAL
 
-  void bvec_toggle(bvec_t* s, int begin, int end, int j) {
+  // First exception thrown by the iterations of a parallel loop, to be rethrown after the
+  // parallel region since an exception must not leave it
+  class ParallelException {
+  public:
+    ParallelException() : failed_(false) {}
+
+    // Has an exception been thrown? The remaining iterations can then be skipped
+    bool failed() const { return failed_;}
+
+    // Store the exception being handled, call from a catch block
+    void store() {
+#ifdef WITH_OPENMP
+#pragma omp critical(casadi_parallel_exception)
+#endif // WITH_OPENMP
+      {
+        if (!ptr_) ptr_ = std::current_exception();
+      }
+      failed_ = true;
+    }
+
+    // Rethrow the stored exception, if any
+    void rethrow() const {
+      if (ptr_) std::rethrow_exception(ptr_);
+    }
+  private:
+    std::atomic<bool> failed_;
+    std::exception_ptr ptr_;
+  };
+
+  // Toggle direction j of nonzeros [begin, end), nw words per nonzero
+  void bvec_toggle(bvec_t* s, int begin, int end, int j, int nw) {
     for (int i=begin; i<end; ++i) {
-      s[i] ^= (bvec_t(1) << j);
+      s[i*nw + j/bvec_size] ^= (bvec_t(1) << (j%bvec_size));
     }
   }
 
@@ -527,10 +685,22 @@ namespace casadi {
   }
 
 
-  void bvec_or(bvec_t* s, bvec_t & r, int begin, int end) {
-    r = 0;
-    for (int i=begin; i<end; ++i) r |= s[i];
+  // Union of the dependencies of nonzeros [begin, end), nw words per nonzero
+  void bvec_or(const bvec_t* s, bvec_t* r, int begin, int end, int nw) {
+    for (int k=0; k<nw; ++k) r[k] = 0;
+    for (int i=begin; i<end; ++i) {
+      for (int k=0; k<nw; ++k) r[k] |= s[i*nw + k];
+    }
   }
+
+  // A sweep with up to sp_words()*bvec_size seed directions in the hierarchical
+  // sparsity detection
+  struct SpSweep {
+    // Seed nonzeros [begin, end) toggled on for direction dir
+    std::vector<int> begin, end, dir;
+    // Offsets of the fine blocks, by direction and coarse block
+    IM lookup;
+  };
   /// \endcond
 
   // Traits
@@ -541,6 +711,10 @@ namespace casadi {
                           int* iw, bvec_t* w, int mem) {
       f->sp_fwd(arg, res, iw, w, mem);
     }
+    static inline void sp_wide(FunctionInternal *f, const bvec_t** arg, bvec_t** res,
+                               int* iw, bvec_t* w, int mem) {
+      f->sp_fwd_wide(arg, res, iw, w, mem);
+    }
   };
   template<> struct JacSparsityTraits<false> {
     typedef bvec_t* arg_t;
@@ -548,6 +722,10 @@ namespace casadi {
                           int* iw, bvec_t* w, int mem) {
       f->sp_rev(arg, res, iw, w, mem);
     }
+    static inline void sp_wide(FunctionInternal *f, bvec_t** arg, bvec_t** res,
+                               int* iw, bvec_t* w, int mem) {
+      f->sp_rev_wide(arg, res, iw, w, mem);
+    }
   };
 
   template<bool fwd>
@@ -557,94 +735,144 @@ namespace casadi {
     int nz_in = nnz_in(iind);
     int nz_out = nnz_out(oind);
 
-    // Evaluation buffers
-    vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), 0);
-    vector<bvec_t*> res(sz_res(), 0);
-    vector<int> iw(sz_iw());
-    vector<bvec_t> w(sz_w(), 0);
+    // Words per nonzero and directions per sweep
+    int nw = sp_words();
+    int ndir = nw*bvec_size;
 
-    // Seeds and sensitivities
-    vector<bvec_t> seed(nz_in, 0);
-    arg[iind] = get_ptr(seed);
-    vector<bvec_t> sens(nz_out, 0);
-    res[oind] = get_ptr(sens);
-    if (!fwd) std::swap(seed, sens);
+    // Number of seed and sensitivity nonzeros
+    int nz_seed = fwd ? nz_in : nz_out;
+    int nz_sens = fwd ? nz_out : nz_in;
 
     // Number of forward sweeps we must make
-    int nsweep = seed.size() / bvec_size;
-    if (seed.size() % bvec_size) nsweep++;
+    int nsweep = nz_seed / ndir;
+    if (nz_seed % ndir) nsweep++;
+
+    // The sweeps are independent and can be made in parallel
+    bool parallel = has_sp_parallel() && nsweep>1;
 
     // Print
     if (verbose()) {
       userOut() << "FunctionInternal::getJacSparsityGen<" << fwd << ">: "
-                << nsweep << " sweeps needed for " << seed.size() << " directions" << endl;
+                << nsweep << " sweeps needed for " << nz_seed << " directions"
+                << (parallel ? " (in parallel)" : "") << endl;
     }
 
-    // Progress
-    int progress = -10;
-
-    // Temporary vectors
+    // Sparsity triplets
     std::vector<int> jcol, jrow;
 
-    // Loop over the variables, bvec_size variables at a time
-    for (int s=0; s<nsweep; ++s) {
-
-      // Print progress
-      if (verbose()) {
-        int progress_new = (s*100)/nsweep;
-        // Print when entering a new decade
-        if (progress_new / 10 > progress / 10) {
-          progress = progress_new;
-          userOut() << progress << " %"  << endl;
-        }
+    // Exceptions are caught in the parallel region and rethrown after it
+    ParallelException exc;
+#ifdef WITH_OPENMP
+#pragma omp parallel if (parallel)
+#endif // WITH_OPENMP
+    {
+      // Evaluation buffers, one set per thread
+      vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), 0);
+      vector<bvec_t*> res(sz_res(), 0);
+      vector<int> iw(sz_iw());
+      vector<bvec_t> w(sz_w()*nw, 0);
+
+      // Seeds and sensitivities
+      vector<bvec_t> seed(nz_seed*nw, 0), sens(nz_sens*nw, 0);
+      if (fwd) {
+        arg[iind] = get_ptr(seed);
+        res[oind] = get_ptr(sens);
+      } else {
+        arg[iind] = get_ptr(sens);
+        res[oind] = get_ptr(seed);
       }
 
-      // Nonzero offset
-      int offset = s*bvec_size;
+      // Progress
+      int progress = -10;
+
+      // Sparsity triplets found by this thread
+      std::vector<int> jcol1, jrow1;
+
+      // Loop over the variables, ndir variables at a time
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif // WITH_OPENMP
+      for (int s=0; s<nsweep; ++s) {
+        if (exc.failed()) continue;
+        try {
+          // Print progress
+          if (verbose() && !parallel) {
+            int progress_new = (s*100)/nsweep;
+            // Print when entering a new decade
+            if (progress_new / 10 > progress / 10) {
+              progress = progress_new;
+              userOut() << progress << " %"  << endl;
+            }
+          }
 
-      // Number of local seed directions
-      int ndir_local = seed.size()-offset;
-      ndir_local = std::min(bvec_size, ndir_local);
+          // Nonzero offset
+          int offset = s*ndir;
 
-      for (int i=0; i<ndir_local; ++i) {
-        seed[offset+i] |= bvec_t(1)<<i;
-      }
+          // Number of local seed directions
+          int ndir_local = nz_seed-offset;
+          ndir_local = std::min(ndir, ndir_local);
 
-      // Propagate the dependencies
-      JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+          for (int i=0; i<ndir_local; ++i) {
+            seed[(offset+i)*nw + i/bvec_size] |= bvec_t(1)<<(i%bvec_size);
+          }
 
-      // Loop over the nonzeros of the output
-      for (int el=0; el<sens.size(); ++el) {
+          // Propagate the dependencies
+          if (nw==1) {
+            JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res), get_ptr(iw),
+                                       get_ptr(w), 0);
+          } else {
+            JacSparsityTraits<fwd>::sp_wide(this, get_ptr(arg), get_ptr(res), get_ptr(iw),
+                                            get_ptr(w), 0);
+          }
 
-        // Get the sparsity sensitivity
-        bvec_t spsens = sens[el];
+          // Loop over the nonzeros of the output
+          for (int el=0; el<nz_sens; ++el) {
+            for (int k=0; k<nw; ++k) {
+              // Get the sparsity sensitivity
+              bvec_t spsens = sens[el*nw + k];
 
-        if (!fwd) {
-          // Clear the sensitivities for the next sweep
-          sens[el] = 0;
-        }
+              if (!fwd) {
+                // Clear the sensitivities for the next sweep
+                sens[el*nw + k] = 0;
+              }
 
-        // If there is a dependency in any of the directions
-        if (spsens!=0) {
+              // If there is a dependency in any of the directions
+              if (spsens!=0) {
 
-          // Loop over seed directions
-          for (int i=0; i<ndir_local; ++i) {
+                // Loop over seed directions
+                int i_end = std::min(bvec_size, ndir_local - k*bvec_size);
+                for (int i=0; i<i_end; ++i) {
 
-            // If dependents on the variable
-            if ((bvec_t(1) << i) & spsens) {
-              // Add to pattern
-              jcol.push_back(el);
-              jrow.push_back(i+offset);
+                  // If dependents on the variable
+                  if ((bvec_t(1) << i) & spsens) {
+                    // Add to pattern
+                    jcol1.push_back(el);
+                    jrow1.push_back(k*bvec_size+i+offset);
+                  }
+                }
+              }
             }
           }
+
+          // Remove the seeds
+          for (int i=0; i<ndir_local; ++i) {
+            seed[(offset+i)*nw + i/bvec_size] = 0;
+          }
+        } catch (...) {
+          exc.store();
         }
       }
 
-      // Remove the seeds
-      for (int i=0; i<ndir_local; ++i) {
-        seed[offset+i] = 0;
+      // Collect the triplets
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+      {
+        jcol.insert(jcol.end(), jcol1.begin(), jcol1.end());
+        jrow.insert(jrow.end(), jrow1.begin(), jrow1.end());
       }
     }
+    exc.rethrow();
 
     // Construct sparsity pattern and return
     if (!fwd) swap(jrow, jcol);
@@ -662,20 +890,6 @@ namespace casadi {
     int nz = nnz_in(iind);
     casadi_assert(nz==nnz_out(oind));
 
-    // Evaluation buffers
-    vector<const bvec_t*> arg(sz_arg(), 0);
-    vector<bvec_t*> res(sz_res(), 0);
-    vector<int> iw(sz_iw());
-    vector<bvec_t> w(sz_w());
-
-    // Seeds
-    vector<bvec_t> seed(nz, 0);
-    arg[iind] = get_ptr(seed);
-
-    // Sensitivities
-    vector<bvec_t> sens(nz, 0);
-    res[oind] = get_ptr(sens);
-
     // Sparsity triplet accumulator
     std::vector<int> jcol, jrow;
 
@@ -685,8 +899,12 @@ namespace casadi {
     // Cols/rows of the fine blocks
     std::vector<int> fine;
 
+    // Words per nonzero and directions per sweep
+    int nw = sp_words();
+    int ndir = nw*bvec_size;
+
     // In each iteration, subdivide each coarse block in this many fine blocks
-    int subdivision = bvec_size;
+    int subdivision = ndir;
 
     Sparsity r = Sparsity::dense(1, 1);
 
@@ -711,9 +929,6 @@ namespace casadi {
 
       casadi_msg("Star coloring on " << r.dim() << ": " << D.size2() << " <-> " << D.size1());
 
-      // Clear the seeds
-      fill(seed.begin(), seed.end(), 0);
-
       // Subdivide the coarse block
       for (int k=0; k<coarse.size()-1; ++k) {
         int diff = coarse[k+1]-coarse[k];
@@ -737,13 +952,16 @@ namespace casadi {
       std::vector<int> lookup_row;
       std::vector<int> lookup_value;
 
+      // Seeds and lookup tables for each sweep, the last one being assembled
+      std::vector<SpSweep> sweeps(1);
+
       // Loop over all coarse seed directions from the coloring
       for (int csd=0; csd<D.size2(); ++csd) {
         // The maximum number of fine blocks contained in one coarse block
         int n_fine_blocks_max = fine_lookup[coarse[1]]-fine_lookup[coarse[0]];
 
         int fci_offset = 0;
-        int fci_cap = bvec_size-bvec_i;
+        int fci_cap = ndir-bvec_i;
 
         // Flag to indicate if all fine blocks have been handled
         bool f_finished = false;
@@ -778,8 +996,9 @@ namespace casadi {
               }
 
               // Toggle on seeds
-              bvec_toggle(get_ptr(seed), fine[fci+fci_start], fine[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+              sweeps.back().begin.push_back(fine[fci+fci_start]);
+              sweeps.back().end.push_back(fine[fci+fci_start+1]);
+              sweeps.back().dir.push_back(bvec_i+bvec_i_mod);
               bvec_i_mod++;
             }
           }
@@ -788,30 +1007,94 @@ namespace casadi {
           bvec_i+= min(n_fine_blocks_max, fci_cap);
 
           // Check if bvec buffer is full
-          if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+          if (bvec_i==ndir || csd==D.size2()-1) {
+            // Calculate sparsity for ndir directions at once
 
             // Statistics
             nsweeps+=1;
 
             // Construct lookup table
             IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value,
-                                    bvec_size, coarse.size());
+                                    ndir, coarse.size());
 
             std::reverse(lookup_col.begin(), lookup_col.end());
             std::reverse(lookup_row.begin(), lookup_row.end());
             std::reverse(lookup_value.begin(), lookup_value.end());
             IM duplicates =
-              IM::triplet(lookup_row, lookup_col, lookup_value, bvec_size, coarse.size())
+              IM::triplet(lookup_row, lookup_col, lookup_value, ndir, coarse.size())
               - lookup;
             duplicates = sparsify(duplicates);
-            lookup(duplicates.sparsity()) = -bvec_size;
+            lookup(duplicates.sparsity()) = -ndir;
 
-            // Propagate the dependencies
-            sp_fwd(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+            sweeps.back().lookup = lookup;
+            sweeps.push_back(SpSweep());
+
+            // Clean lookup table
+            lookup_col.clear();
+            lookup_row.clear();
+            lookup_value.clear();
+          }
+
+          if (n_fine_blocks_max>fci_cap) {
+            fci_offset += min(n_fine_blocks_max, fci_cap);
+            bvec_i = 0;
+            fci_cap = ndir;
+          } else {
+            f_finished = true;
+          }
+        }
+      }
+
+      // Make the sweeps, which are independent of each other
+      sweeps.pop_back();
+      bool parallel = has_sp_parallel() && sweeps.size()>1;
+      casadi_msg(sweeps.size() << " sweeps" << (parallel ? " in parallel" : ""));
+      // Exceptions are caught in the parallel region and rethrown after it
+      ParallelException exc;
+#ifdef WITH_OPENMP
+#pragma omp parallel if (parallel)
+#endif // WITH_OPENMP
+      {
+        // Evaluation buffers, one set per thread
+        vector<const bvec_t*> arg(sz_arg(), 0);
+        vector<bvec_t*> res(sz_res(), 0);
+        vector<int> iw(sz_iw());
+        vector<bvec_t> w(sz_w()*nw);
+
+        // Seeds
+        vector<bvec_t> seed(nz*nw, 0);
+        arg[iind] = get_ptr(seed);
+
+        // Sensitivities
+        vector<bvec_t> sens(nz*nw, 0);
+        res[oind] = get_ptr(sens);
+
+        // Dependencies of a fine block
+        vector<bvec_t> spsens(nw);
+
+        // Sparsity triplets found by this thread
+        std::vector<int> jcol1, jrow1;
+
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif // WITH_OPENMP
+        for (int s=0; s<static_cast<int>(sweeps.size()); ++s) {
+          if (exc.failed()) continue;
+          try {
+            const SpSweep& sw = sweeps[s];
+            const IM& lookup = sw.lookup;
+
+            // Toggle on seeds
+            for (int k=0; k<sw.dir.size(); ++k) {
+              bvec_toggle(get_ptr(seed), sw.begin[k], sw.end[k], sw.dir[k], nw);
+            }
 
-            // Temporary bit work vector
-            bvec_t spsens;
+            // Propagate the dependencies
+            if (nw==1) {
+              sp_fwd(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+            } else {
+              sp_fwd_wide(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+            }
 
             // Loop over the cols of coarse blocks
             for (int cri=0; cri<coarse.size()-1; ++cri) {
@@ -819,20 +1102,20 @@ namespace casadi {
               // Loop over the cols of fine blocks within the current coarse block
               for (int fri=fine_lookup[coarse[cri]];fri<fine_lookup[coarse[cri+1]];++fri) {
                 // Lump individual sensitivities together into fine block
-                bvec_or(get_ptr(sens), spsens, fine[fri], fine[fri+1]);
+                bvec_or(get_ptr(sens), get_ptr(spsens), fine[fri], fine[fri+1], nw);
 
-                // Loop over all bvec_bits
-                for (int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & (bvec_t(1) << bvec_i)) {
+                // Loop over all directions
+                for (int bvec_i=0;bvec_i<ndir;++bvec_i) {
+                  if (spsens[bvec_i/bvec_size] & (bvec_t(1) << (bvec_i%bvec_size))) {
                     // if dependency is found, add it to the new sparsity pattern
                     int ind = lookup.sparsity().get_nz(bvec_i, cri);
                     if (ind==-1) continue;
-                    int lk = lookup->at(ind);
-                    if (lk>-bvec_size) {
-                      jrow.push_back(bvec_i+lk);
-                      jcol.push_back(fri);
-                      jrow.push_back(fri);
-                      jcol.push_back(bvec_i+lk);
+                    int lk = lookup.nonzeros()[ind];
+                    if (lk>-ndir) {
+                      jrow1.push_back(bvec_i+lk);
+                      jcol1.push_back(fri);
+                      jrow1.push_back(fri);
+                      jcol1.push_back(bvec_i+lk);
                     }
                   }
                 }
@@ -841,22 +1124,21 @@ namespace casadi {
 
             // Clear the forward seeds/adjoint sensitivities, ready for next bvec sweep
             fill(seed.begin(), seed.end(), 0);
-
-            // Clean lookup table
-            lookup_col.clear();
-            lookup_row.clear();
-            lookup_value.clear();
+          } catch (...) {
+            exc.store();
           }
+        }
 
-          if (n_fine_blocks_max>fci_cap) {
-            fci_offset += min(n_fine_blocks_max, fci_cap);
-            bvec_i = 0;
-            fci_cap = bvec_size;
-          } else {
-            f_finished = true;
-          }
+        // Collect the triplets
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+        {
+          jcol.insert(jcol.end(), jcol1.begin(), jcol1.end());
+          jrow.insert(jrow.end(), jrow1.begin(), jrow1.end());
         }
       }
+      exc.rethrow();
 
       // Construct fine sparsity pattern
       r = Sparsity::triplet(fine.size()-1, fine.size()-1, jrow, jcol);
@@ -885,19 +1167,6 @@ namespace casadi {
     // Number of nonzero outputs
     int nz_out = nnz_out(oind);
 
-    // Seeds and sensitivities
-    vector<bvec_t> s_in(nz_in, 0);
-    vector<bvec_t> s_out(nz_out, 0);
-
-    // Evaluation buffers
-    vector<const bvec_t*> arg_fwd(sz_arg(), 0);
-    vector<bvec_t*> arg_adj(sz_arg(), 0);
-    arg_fwd[iind] = arg_adj[iind] = get_ptr(s_in);
-    vector<bvec_t*> res(sz_res(), 0);
-    res[oind] = get_ptr(s_out);
-    vector<int> iw(sz_iw());
-    vector<bvec_t> w(sz_w());
-
     // Sparsity triplet accumulator
     std::vector<int> jcol, jrow;
 
@@ -912,8 +1181,12 @@ namespace casadi {
     // Rows of the fine blocks
     std::vector<int> fine_row;
 
+    // Words per nonzero and directions per sweep
+    int nw = sp_words();
+    int ndir = nw*bvec_size;
+
     // In each iteration, subdivide each coarse block in this many fine blocks
-    int subdivision = bvec_size;
+    int subdivision = ndir;
 
     Sparsity r = Sparsity::dense(1, 1);
 
@@ -930,13 +1203,6 @@ namespace casadi {
     // Get weighting factor
     double sp_w = sp_weight();
 
-    // Lookup table for bvec_t
-    std::vector<bvec_t> bvec_lookup;
-    bvec_lookup.reserve(bvec_size);
-    for (int i=0;i<bvec_size;++i) {
-      bvec_lookup.push_back(bvec_t(1) << i);
-    }
-
     while (!hasrun || coarse_col.size()!=nz_out+1 || coarse_row.size()!=nz_in+1) {
       casadi_msg("Block size: " << granularity_col << " x " << granularity_row);
 
@@ -976,17 +1242,10 @@ namespace casadi {
                    << (1-sp_w)*D2.size2()*adj_cost << ")");
       }
 
-      // Get seeds and sensitivities
-      bvec_t* seed_v = use_fwd ? get_ptr(s_in) : get_ptr(s_out);
-      bvec_t* sens_v = use_fwd ? get_ptr(s_out) : get_ptr(s_in);
-
       // The number of zeros in the seed and sensitivity directions
       int nz_seed = use_fwd ? nz_in  : nz_out;
       int nz_sens = use_fwd ? nz_out : nz_in;
 
-      // Clear the seeds
-      for (int i=0; i<nz_seed; ++i) seed_v[i]=0;
-
       // Choose the active jacobian coloring scheme
       Sparsity D = use_fwd ? D1 : D2;
 
@@ -1031,6 +1290,9 @@ namespace casadi {
       std::vector<int> lookup_row;
       std::vector<int> lookup_value;
 
+      // Seeds and lookup tables for each sweep, the last one being assembled
+      std::vector<SpSweep> sweeps(1);
+
       // Loop over all coarse seed directions from the coloring
       for (int csd=0; csd<D.size2(); ++csd) {
 
@@ -1038,7 +1300,7 @@ namespace casadi {
         int n_fine_blocks_max = fine_row_lookup[coarse_row[1]]-fine_row_lookup[coarse_row[0]];
 
         int fci_offset = 0;
-        int fci_cap = bvec_size-bvec_i;
+        int fci_cap = ndir-bvec_i;
 
         // Flag to indicate if all fine blocks have been handled
         bool f_finished = false;
@@ -1071,8 +1333,9 @@ namespace casadi {
               }
 
               // Toggle on seeds
-              bvec_toggle(seed_v, fine_row[fci+fci_start], fine_row[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+              sweeps.back().begin.push_back(fine_row[fci+fci_start]);
+              sweeps.back().end.push_back(fine_row[fci+fci_start+1]);
+              sweeps.back().dir.push_back(bvec_i+bvec_i_mod);
               bvec_i_mod++;
             }
           }
@@ -1081,27 +1344,96 @@ namespace casadi {
           bvec_i+= min(n_fine_blocks_max, fci_cap);
 
           // Check if bvec buffer is full
-          if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+          if (bvec_i==ndir || csd==D.size2()-1) {
+            // Calculate sparsity for ndir directions at once
 
             // Statistics
             nsweeps+=1;
 
             // Construct lookup table
-            IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value, bvec_size,
-                                    coarse_col.size());
+            sweeps.back().lookup = IM::triplet(lookup_row, lookup_col, lookup_value, ndir,
+                                               coarse_col.size());
+            sweeps.push_back(SpSweep());
+
+            // Clean lookup table
+            lookup_col.clear();
+            lookup_row.clear();
+            lookup_value.clear();
+          }
+
+          if (n_fine_blocks_max>fci_cap) {
+            fci_offset += min(n_fine_blocks_max, fci_cap);
+            bvec_i = 0;
+            fci_cap = ndir;
+          } else {
+            f_finished = true;
+          }
+
+        }
+
+      }
+
+      // Make the sweeps, which are independent of each other
+      sweeps.pop_back();
+      bool parallel = has_sp_parallel() && sweeps.size()>1;
+      casadi_msg(sweeps.size() << " sweeps" << (parallel ? " in parallel" : ""));
+      // Exceptions are caught in the parallel region and rethrown after it
+      ParallelException exc;
+#ifdef WITH_OPENMP
+#pragma omp parallel if (parallel)
+#endif // WITH_OPENMP
+      {
+        // Seeds and sensitivities, one set per thread
+        vector<bvec_t> s_in(nz_in*nw, 0);
+        vector<bvec_t> s_out(nz_out*nw, 0);
+        bvec_t* seed_v = use_fwd ? get_ptr(s_in) : get_ptr(s_out);
+        bvec_t* sens_v = use_fwd ? get_ptr(s_out) : get_ptr(s_in);
+
+        // Evaluation buffers
+        vector<const bvec_t*> arg_fwd(sz_arg(), 0);
+        vector<bvec_t*> arg_adj(sz_arg(), 0);
+        arg_fwd[iind] = arg_adj[iind] = get_ptr(s_in);
+        vector<bvec_t*> res(sz_res(), 0);
+        res[oind] = get_ptr(s_out);
+        vector<int> iw(sz_iw());
+        vector<bvec_t> w(sz_w()*nw);
+
+        // Dependencies of a fine block
+        vector<bvec_t> spsens(nw);
+
+        // Sparsity triplets found by this thread
+        std::vector<int> jcol1, jrow1;
+
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif // WITH_OPENMP
+        for (int s=0; s<static_cast<int>(sweeps.size()); ++s) {
+          if (exc.failed()) continue;
+          try {
+            const SpSweep& sw = sweeps[s];
+            const IM& lookup = sw.lookup;
+
+            // Toggle on seeds
+            for (int k=0; k<sw.dir.size(); ++k) {
+              bvec_toggle(seed_v, sw.begin[k], sw.end[k], sw.dir[k], nw);
+            }
 
             // Propagate the dependencies
             if (use_fwd) {
-              sp_fwd(get_ptr(arg_fwd), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              if (nw==1) {
+                sp_fwd(get_ptr(arg_fwd), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              } else {
+                sp_fwd_wide(get_ptr(arg_fwd), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              }
             } else {
               fill(w.begin(), w.end(), 0);
-              sp_rev(get_ptr(arg_adj), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              if (nw==1) {
+                sp_rev(get_ptr(arg_adj), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              } else {
+                sp_rev_wide(get_ptr(arg_adj), get_ptr(res), get_ptr(iw), get_ptr(w), 0);
+              }
             }
 
-            // Temporary bit work vector
-            bvec_t spsens;
-
             // Loop over the cols of coarse blocks
             for (int cri=0;cri<coarse_col.size()-1;++cri) {
 
@@ -1109,19 +1441,21 @@ namespace casadi {
               for (int fri=fine_col_lookup[coarse_col[cri]];
                    fri<fine_col_lookup[coarse_col[cri+1]];++fri) {
                 // Lump individual sensitivities together into fine block
-                bvec_or(sens_v, spsens, fine_col[fri], fine_col[fri+1]);
-
-                // Next iteration if no sparsity
-                if (!spsens) continue;
-
-                // Loop over all bvec_bits
-                for (int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & bvec_lookup[bvec_i]) {
+                bvec_or(sens_v, get_ptr(spsens), fine_col[fri], fine_col[fri+1], nw);
+
+                // Loop over all directions, skipping words without dependencies
+                for (int bvec_i=0;bvec_i<ndir;++bvec_i) {
+                  bvec_t spsens_k = spsens[bvec_i/bvec_size];
+                  if (!spsens_k) {
+                    bvec_i += bvec_size-1-bvec_i%bvec_size;
+                    continue;
+                  }
+                  if (spsens_k & (bvec_t(1) << (bvec_i%bvec_size))) {
                     // if dependency is found, add it to the new sparsity pattern
                     int ind = lookup.sparsity().get_nz(bvec_i, cri);
                     if (ind==-1) continue;
-                    jrow.push_back(bvec_i+lookup->at(ind));
-                    jcol.push_back(fri);
+                    jrow1.push_back(bvec_i+lookup.nonzeros()[ind]);
+                    jcol1.push_back(fri);
                   }
                 }
               }
@@ -1132,24 +1466,21 @@ namespace casadi {
 
             // Clear the adjoint seeds/forward sensitivities, ready for next bvec sweep
             fill(s_out.begin(), s_out.end(), 0);
-
-            // Clean lookup table
-            lookup_col.clear();
-            lookup_row.clear();
-            lookup_value.clear();
+          } catch (...) {
+            exc.store();
           }
-
-          if (n_fine_blocks_max>fci_cap) {
-            fci_offset += min(n_fine_blocks_max, fci_cap);
-            bvec_i = 0;
-            fci_cap = bvec_size;
-          } else {
-            f_finished = true;
-          }
-
         }
 
+        // Collect the triplets
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+        {
+          jcol.insert(jcol.end(), jcol1.begin(), jcol1.end());
+          jrow.insert(jrow.end(), jrow1.begin(), jrow1.end());
+        }
       }
+      exc.rethrow();
 
       // Swap results if adjoint mode was used
       if (use_fwd) {
@@ -1172,9 +1503,167 @@ namespace casadi {
     return r.T();
   }
 
+  // Entries of the persistent sparsity cache
+  enum SparsityCacheTag {SP_CACHE_JAC, SP_CACHE_COLORING};
+
+  // Magic string and format version of a sparsity cache file
+  static const char sp_cache_magic[8] = {'C', 'A', 'S', 'A', 'D', 'I', 'S', 'P'};
+  static const int sp_cache_version = 2;
+
+  // File in the sparsity cache directory holding an entry
+  static std::string sp_cache_file(std::size_t key) {
+    stringstream ss;
+    ss << GlobalOptions::sparsity_cache << "/sparsity_" << hex << setw(16) << setfill('0')
+       << static_cast<unsigned long long>(key) << ".bin";
+    return ss.str();
+  }
+
+  static void sp_cache_write(ostream& s, int v) {
+    s.write(reinterpret_cast<const char*>(&v), sizeof(int));
+  }
+
+  static int sp_cache_read(istream& s) {
+    int v;
+    s.read(reinterpret_cast<char*>(&v), sizeof(int));
+    return v;
+  }
+
+  // Write a list of patterns, null patterns are stored with a negative number of rows
+  static void sp_cache_write(ostream& s, const vector<Sparsity>& sp) {
+    sp_cache_write(s, sp.size());
+    for (int i=0; i<sp.size(); ++i) {
+      if (sp[i].is_null()) {
+        sp_cache_write(s, -1);
+        sp_cache_write(s, 0);
+        continue;
+      }
+      sp_cache_write(s, sp[i].size1());
+      sp_cache_write(s, sp[i].size2());
+      s.write(reinterpret_cast<const char*>(sp[i].colind()), (sp[i].size2()+1)*sizeof(int));
+      s.write(reinterpret_cast<const char*>(sp[i].row()), sp[i].nnz()*sizeof(int));
+    }
+  }
+
+  // Read a list of patterns, false if unreadable
+  static bool sp_cache_read(istream& s, vector<Sparsity>& sp) {
+    int n = sp_cache_read(s);
+    if (!s || n<0) return false;
+    sp.resize(n);
+    for (int i=0; i<n; ++i) {
+      int nrow = sp_cache_read(s);
+      int ncol = sp_cache_read(s);
+      if (!s || ncol<0) return false;
+      if (nrow<0) {
+        sp[i] = Sparsity();
+        continue;
+      }
+      vector<int> colind(ncol+1);
+      s.read(reinterpret_cast<char*>(get_ptr(colind)), colind.size()*sizeof(int));
+      if (!s || colind.front()!=0 || colind.back()<0) return false;
+      vector<int> row(colind.back());
+      if (!row.empty()) s.read(reinterpret_cast<char*>(get_ptr(row)), row.size()*sizeof(int));
+      if (!s) return false;
+      try {
+        sp[i] = Sparsity(nrow, ncol, colind, row);
+      } catch (CasadiException&) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Load patterns from the sparsity cache, false if not found, unreadable or stored for
+  // a function with different input and output sparsities (io), e.g. after a hash collision
+  static bool sp_cache_load(std::size_t key, const vector<Sparsity>& io, vector<Sparsity>& sp) {
+    ifstream in(sp_cache_file(key).c_str(), ios::binary);
+    if (!in) return false;
+    char magic[sizeof(sp_cache_magic)];
+    in.read(magic, sizeof(magic));
+    if (!in || memcmp(magic, sp_cache_magic, sizeof(magic))) return false;
+    if (sp_cache_read(in)!=sp_cache_version) return false;
+    unsigned long long key_file;
+    in.read(reinterpret_cast<char*>(&key_file), sizeof(key_file));
+    if (!in || key_file!=key) return false;
+    vector<Sparsity> io_file;
+    if (!sp_cache_read(in, io_file) || io_file.size()!=io.size()) return false;
+    for (int i=0; i<io.size(); ++i) {
+      if (io_file[i].is_null() || io_file[i]!=io[i]) return false;
+    }
+    return sp_cache_read(in, sp);
+  }
+
+  // Save patterns to the sparsity cache, silently ignoring failure
+  static void sp_cache_save(std::size_t key, const vector<Sparsity>& io,
+                            const vector<Sparsity>& sp) {
+    // Write to a file unique to the process and call first, then rename into place,
+    // so that readers and concurrent writers never see a partial entry
+    static std::atomic<int> counter(0);
+#ifdef _WIN32
+    int pid = _getpid();
+#else // _WIN32
+    int pid = getpid();
+#endif // _WIN32
+    string fname = sp_cache_file(key);
+    stringstream tmpname_ss;
+    tmpname_ss << fname << "." << pid << "_" << counter++ << ".tmp";
+    string tmpname = tmpname_ss.str();
+    {
+      ofstream out(tmpname.c_str(), ios::binary);
+      if (!out) return;
+      out.write(sp_cache_magic, sizeof(sp_cache_magic));
+      sp_cache_write(out, sp_cache_version);
+      unsigned long long key_file = key;
+      out.write(reinterpret_cast<const char*>(&key_file), sizeof(key_file));
+      sp_cache_write(out, io);
+      sp_cache_write(out, sp);
+      if (!out) {
+        out.close();
+        remove(tmpname.c_str());
+        return;
+      }
+    }
+    if (rename(tmpname.c_str(), fname.c_str())) remove(tmpname.c_str());
+  }
+
+  vector<Sparsity> FunctionInternal::sparsity_io() const {
+    vector<Sparsity> ret;
+    for (int i=0; i<n_in(); ++i) ret.push_back(sparsity_in(i));
+    for (int i=0; i<n_out(); ++i) ret.push_back(sparsity_out(i));
+    return ret;
+  }
+
+  std::size_t FunctionInternal::sparsity_cache_key(int tag, int iind, int oind, bool compact,
+                                                   bool symmetric) const {
+    if (GlobalOptions::sparsity_cache.empty()) return 0;
+    std::size_t h = structure_hash();
+    if (h==0) return 0;
+    hash_combine(h, tag);
+    hash_combine(h, iind);
+    hash_combine(h, oind);
+    hash_combine(h, compact);
+    hash_combine(h, symmetric);
+    if (tag==SP_CACHE_COLORING && !symmetric) {
+      // The coloring depends on the AD weighting
+      double w = ad_weight();
+      unsigned long long w_bits;
+      memcpy(&w_bits, &w, sizeof(w));
+      hash_combine(h, w_bits);
+    }
+    return h==0 ? 1 : h;
+  }
+
   Sparsity FunctionInternal::getJacSparsity(int iind, int oind, bool symmetric) {
     // Check if we are able to propagate dependencies through the function
     if (has_spfwd() || has_sprev()) {
+      // Consult the persistent sparsity cache
+      std::size_t key = sparsity_cache_key(SP_CACHE_JAC, iind, oind, true, symmetric);
+      vector<Sparsity> cached;
+      if (key && sp_cache_load(key, sparsity_io(), cached) && cached.size()==1
+          && cached[0].size1()==nnz_out(oind) && cached[0].size2()==nnz_in(iind)) {
+        casadi_msg("Jacobian sparsity pattern read from " << sp_cache_file(key));
+        return cached[0];
+      }
+
       Sparsity sp;
       if (nnz_in(iind)>3*bvec_size && nnz_out(oind)>3*bvec_size &&
             GlobalOptions::hierarchical_sparsity) {
@@ -1188,13 +1677,16 @@ namespace casadi {
         int nz_in = nnz_in(iind);
         int nz_out = nnz_out(oind);
 
+        // Directions per sweep
+        int ndir = sp_words()*bvec_size;
+
         // Number of forward sweeps we must make
-        int nsweep_fwd = nz_in/bvec_size;
-        if (nz_in%bvec_size) nsweep_fwd++;
+        int nsweep_fwd = nz_in/ndir;
+        if (nz_in%ndir) nsweep_fwd++;
 
         // Number of adjoint sweeps we must make
-        int nsweep_adj = nz_out/bvec_size;
-        if (nz_out%bvec_size) nsweep_adj++;
+        int nsweep_adj = nz_out/ndir;
+        if (nz_out%ndir) nsweep_adj++;
 
         // Get weighting factor
         double w = sp_weight();
@@ -1211,6 +1703,7 @@ namespace casadi {
       // This can lead to an assymetrical result
       //  cf. #1522
       if (symmetric) sp=sp*sp.T();
+      if (key) sp_cache_save(key, sparsity_io(), vector<Sparsity>(1, sp));
       return sp;
     } else {
       // Dense sparsity by default
@@ -1290,6 +1783,18 @@ namespace casadi {
     Sparsity &AT = sparsity_jac(iind, oind, compact, symmetric);
     Sparsity A = symmetric ? AT : AT.T();
 
+    // Consult the persistent sparsity cache
+    std::size_t key = sparsity_cache_key(SP_CACHE_COLORING, iind, oind, compact, symmetric);
+    if (key) {
+      vector<Sparsity> cached;
+      if (sp_cache_load(key, sparsity_io(), cached) && cached.size()==2) {
+        casadi_msg("Coloring read from " << sp_cache_file(key));
+        D1 = cached[0];
+        D2 = cached[1];
+        return;
+      }
+    }
+
     // Get seed matrices by graph coloring
     if (symmetric) {
       casadi_assert(get_n_forward()>0);
@@ -1360,6 +1865,14 @@ namespace casadi {
       }
 
     }
+
+    // Store in the persistent sparsity cache
+    if (key) {
+      vector<Sparsity> sp(2);
+      sp[0] = D1;
+      sp[1] = D2;
+      sp_cache_save(key, sparsity_io(), sp);
+    }
     log("FunctionInternal::getPartition end");
   }
 
@@ -1768,6 +2281,57 @@ namespace casadi {
     g.body << "}" << endl << endl;
   }
 
+  void FunctionInternal::generateBatch(CodeGenerator& g,
+                                       const std::string& fname, bool decl_static) const {
+    // Add standard math
+    g.addInclude("math.h");
+
+    // Add auxiliaries
+    g.addAuxiliary(CodeGenerator::AUX_SQ);
+    g.addAuxiliary(CodeGenerator::AUX_SIGN);
+
+    // Generate declarations
+    generateDeclarations(g);
+
+    // Define function
+    g.body << "/* " << name_ << ", batched */" << endl;
+    if (decl_static) {
+      g.body << "static ";
+    } else if (g.cpp) {
+      g.body << "extern \"C\" ";
+    }
+    g.body << batch_signature(fname) << " {" << endl;
+    generateBatchBody(g);
+    g.body << "  return 0;" << endl;
+    g.body << "}" << endl << endl;
+  }
+
+  std::string FunctionInternal::batch_signature(const std::string& fname) const {
+    return "int " + fname + "(const real_t** arg, real_t** res, int* iw, real_t* w, int n)";
+  }
+
+  void FunctionInternal::generateBatchBody(CodeGenerator& g) const {
+    casadi_error("'generateBatchBody' not defined for " + type_name());
+  }
+
+  void FunctionInternal::addBatchDependency(CodeGenerator& g) const {
+    // Get the current number of batched functions before looking for it
+    size_t num_f_before = g.added_batch_.size();
+
+    // Get index of the pattern
+    int& ind = g.added_batch_[this];
+
+    // Generate it if it does not exist
+    if (g.added_batch_.size() > num_f_before) {
+      ind = num_f_before;
+      string name = codegen_batch_name(g);
+      generateBatch(g, "CASADI_PREFIX(" + name + ")", true);
+      g.body
+        << "#define " << name << "(arg, res, iw, w, n) "
+        << "CASADI_PREFIX(" << name << ")(arg, res, iw, w, n)" << endl << endl;
+    }
+  }
+
   std::string FunctionInternal::signature(const std::string& fname) const {
     if (simplifiedCall()) {
       return "void " + fname + "(const real_t* arg, real_t* res)";
@@ -2010,6 +2574,12 @@ namespace casadi {
     return ss.str();
   }
 
+  std::string FunctionInternal::codegen_batch_name(const CodeGenerator& g) const {
+    auto it=g.added_batch_.find(this);
+    casadi_assert(it!=g.added_batch_.end());
+    return "b" + CodeGenerator::to_string(it->second);
+  }
+
   void FunctionInternal::addShorthand(CodeGenerator& g, const string& name) const {
     if (simplifiedCall()) {
       g.body
@@ -2121,6 +2691,15 @@ namespace casadi {
     }
   }
 
+  void FunctionInternal::sp_fwd_wide(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w,
+                                     int mem) {
+    casadi_error("'sp_fwd_wide' not defined for " + type_name());
+  }
+
+  void FunctionInternal::sp_rev_wide(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    casadi_error("'sp_rev_wide' not defined for " + type_name());
+  }
+
   void FunctionInternal::sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
     // Get the number of inputs and outputs
     int n_in = this->n_in();
@@ -2725,10 +3304,13 @@ namespace casadi {
   }
 
   void FunctionInternal::clear_memory() {
-    for (auto&& i : mem_) {
-      if (i!=0) free_memory(i);
+    for (int i=0; i<nmem_; ++i) {
+      void*& m = mem_[mem_block(i)][i + 1 - (1 << mem_block(i))];
+      if (m!=0) free_memory(m);
+      m = 0;
     }
-    mem_.clear();
+    nmem_ = 0;
+    unused_.clear();
   }
 
   size_t FunctionInternal::get_n_in() {
@@ -2777,30 +3359,49 @@ namespace casadi {
     return Sparsity::scalar();
   }
 
+  int FunctionInternal::mem_block(int ind) {
+    // Block b holds the memory objects 2^b-1, ..., 2^(b+1)-2
+    int b = 0;
+    for (int i=ind+1; i>1; i >>= 1) b++;
+    return b;
+  }
+
   void* FunctionInternal::memory(int ind) const {
-    return mem_.at(ind);
+    int b = ind>=0 ? mem_block(ind) : 0;
+    casadi_assert_message(ind>=0 && mem_[b]!=0, "Memory object " << ind << " does not exist");
+    return mem_[b][ind + 1 - (1 << b)];
   }
 
   int FunctionInternal::checkout() const {
+#ifdef WITH_THREAD
+    std::lock_guard<std::mutex> lock(mem_mtx_);
+#endif // WITH_THREAD
     if (unused_.empty()) {
       // Allocate a new memory object
       int n_mem = this->n_mem();
-      casadi_assert_message(n_mem==0 || mem_.size()<n_mem,
+      casadi_assert_message(n_mem==0 || nmem_<n_mem,
                             "Too many memory objects");
+      int ind = nmem_;
+      int b = mem_block(ind);
+      if (mem_[b]==0) mem_[b] = new void*[1 << b]();
       void* m = alloc_memory();
-      mem_.push_back(m);
       if (m) init_memory(m);
-      return mem_.size()-1;
+      mem_[b][ind + 1 - (1 << b)] = m;
+      nmem_ = ind+1;
+      return ind;
     } else {
       // Use an unused memory object
-      int m = unused_.top();
-      unused_.pop();
+      int m = unused_.back();
+      unused_.pop_back();
       return m;
     }
   }
 
   void FunctionInternal::release(int mem) const {
-    unused_.push(mem);
+#ifdef WITH_THREAD
+    std::lock_guard<std::mutex> lock(mem_mtx_);
+#endif // WITH_THREAD
+    unused_.push_back(mem);
   }
 
   Function FunctionInternal::
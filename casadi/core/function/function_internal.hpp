@@ -30,6 +30,10 @@
 #include "../weak_ref.hpp"
 #include <set>
 #include <stack>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
 #include "code_generator.hpp"
 #include "importer.hpp"
 #include "../sparse_storage.hpp"
@@ -145,6 +149,11 @@ namespace casadi {
     virtual bool has_sprev() const { return false;}
     ///@}
 
+    /** \brief  Can sparsity be propagated by several threads at once?
+     * If true, the Jacobian sparsity sweeps are made in parallel
+     */
+    virtual bool has_sp_parallel() const { return false;}
+
     ///@{
     /** \brief  Evaluate numerically */
     void _eval(const double** arg, double** res, int* iw, double* w, int mem);
@@ -530,9 +539,40 @@ namespace casadi {
     /** \brief Is codegen supported? */
     virtual bool has_codegen() const { return false;}
 
+    /** \brief Can a batched variant, evaluating several instances, be generated? */
+    virtual bool has_batch() const { return false;}
+
+    /** \brief Generate the batched variant of the function */
+    void generateBatch(CodeGenerator& g, const std::string& fname, bool decl_static) const;
+
+    /** \brief Signature of the batched variant */
+    std::string batch_signature(const std::string& fname) const;
+
+    /** \brief Generate code for the body of the batched variant */
+    virtual void generateBatchBody(CodeGenerator& g) const;
+
+    /** \brief Add the batched variant of a dependent function */
+    void addBatchDependency(CodeGenerator& g) const;
+
+    /** \brief Get name of the batched variant in codegen */
+    std::string codegen_batch_name(const CodeGenerator& g) const;
+
     /** \brief Jit dependencies */
     virtual void jit_dependencies(const std::string& fname) {}
 
+    /** \brief Compile generated code and redirect numerical evaluation to it */
+    void jit_load(const std::vector<std::string>& jit_file);
+
+    /** \brief Compile generated code and look up the evaluation function
+        Does not access any function object, so that it can run in a background thread
+    */
+    static void jit_compile(const std::vector<std::string>& jit_file, const std::string& plugin,
+                            const Dict& opts, const std::string& fname,
+                            Importer& compiler, simple_t& simple, eval_t& eval);
+
+    /** \brief Redirect numerical evaluation once a background compilation is ready */
+    void jit_poll();
+
     /** \brief  Print */
     virtual void print(std::ostream &stream) const;
 
@@ -600,6 +640,18 @@ namespace casadi {
     /// Generate the sparsity of a Jacobian block
     virtual Sparsity getJacSparsity(int iind, int oind, bool symmetric);
 
+    /** \brief Hash of everything that determines the dependency structure
+     * Zero if not available, in which case the persistent sparsity cache is not used
+     */
+    virtual std::size_t structure_hash() const { return 0;}
+
+    /** \brief Key into the persistent sparsity cache, zero if the cache is not used */
+    std::size_t sparsity_cache_key(int tag, int iind, int oind, bool compact,
+                                   bool symmetric) const;
+
+    /** \brief Input and output sparsities, stored in and checked against the sparsity cache */
+    std::vector<Sparsity> sparsity_io() const;
+
     /// Get the sparsity pattern, forward mode
     template<bool fwd>
     Sparsity getJacSparsityGen(int iind, int oind, bool symmetric, int gr_i=1, int gr_o=1);
@@ -694,6 +746,22 @@ namespace casadi {
     /** \brief  Propagate sparsity backwards */
     virtual void sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
 
+    /** \brief  Number of bvec_t words per nonzero in wide sparsity propagation
+        With more than one word, the Jacobian sparsity is calculated with
+        sp_words()*bvec_size directions per sweep, using sp_fwd_wide and sp_rev_wide.
+    */
+    virtual int sp_words() const { return 1;}
+
+    /** \brief  Propagate sparsity forward, sp_words() consecutive words per nonzero
+        The work vector must have length sz_w()*sp_words().
+    */
+    virtual void sp_fwd_wide(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+    /** \brief  Propagate sparsity backwards, sp_words() consecutive words per nonzero
+        The work vector must have length sz_w()*sp_words().
+    */
+    virtual void sp_rev_wide(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
     /** \brief Get number of temporary variables needed */
     void sz_work(size_t& sz_arg, size_t& sz_res, size_t& sz_iw, size_t& sz_w) const;
 
@@ -724,10 +792,18 @@ namespace casadi {
     /** \brief Ensure work vectors long enough to evaluate function */
     void alloc(const Function& f, bool persistent=false);
 
-    /// Memory objects
+    /// Memory objects, can be called concurrently with checkout and release
     void* memory(int ind) const;
 
-    /** \brief Create memory block */
+    /** \brief Does the function have memory objects
+        If so, concurrent evaluations must use different memory objects
+    */
+    bool has_memory() const { return mem_[0]!=0 && mem_[0][0]!=0;}
+
+    /** \brief Create memory block
+        Concurrent evaluations use different memory blocks, so all state that is modified
+        during an evaluation should be kept here and not in the class itself.
+    */
     virtual void* alloc_memory() const {return 0;}
 
     /** \brief Initalize memory block */
@@ -745,7 +821,7 @@ namespace casadi {
     ///@{
     /// Get all statistics
     virtual Dict get_stats(void* mem) const { return Dict();}
-    virtual Dict _get_stats(int mem) const { return get_stats(memory(mem));}
+    virtual Dict _get_stats(int mem) const;
     ///@}
 
     ///@{
@@ -782,10 +858,10 @@ namespace casadi {
     virtual bool adjViaJac(int nadj);
     ///@}
 
-    /// Checkout a memory object
+    /// Checkout a memory object, thread-safe if compiled with WITH_THREAD
     int checkout() const;
 
-    /// Release a memory object
+    /// Release a memory object, thread-safe if compiled with WITH_THREAD
     void release(int mem) const;
 
     /// Input and output sparsity
@@ -800,9 +876,11 @@ namespace casadi {
     /** \brief  Use just-in-time compiler */
     bool jit_;
 
-    /** \brief Numerical evaluation redirected to a C function */
-    eval_t eval_;
-    simple_t simple_;
+    /** \brief Numerical evaluation redirected to a C function
+        Atomic since they can be set by a background compilation (jit_async)
+    */
+    std::atomic<eval_t> eval_;
+    std::atomic<simple_t> simple_;
 
     /** \brief Dict of statistics (resulting from evaluate) */
     Dict stats_;
@@ -834,7 +912,29 @@ namespace casadi {
     /// Just-in-time compiler
     std::string compilerplugin_;
     Importer compiler_;
-    Dict jit_options_;
+    Dict jit_options_, jit_codegen_options_;
+
+    /// Compile in a background thread, evaluating with the interpreter meanwhile
+    bool jit_async_;
+    std::thread jit_thread_;
+
+    /// Status of the background compilation
+    enum JitStatus {JIT_COMPILING, JIT_READY, JIT_FAILED};
+
+    /** \brief Result of a background compilation
+        Owned jointly with the compiling thread, which never accesses the function object.
+        The fields are written before status is released as JIT_READY or JIT_FAILED
+    */
+    struct JitState {
+      std::atomic<int> status;
+      Importer compiler;
+      simple_t simple;
+      eval_t eval;
+      /// Seconds after finalize when the compiled code was ready, or the error
+      double t_switch;
+      std::string error;
+    };
+    std::shared_ptr<JitState> jit_state_;
 
     /// Penalty factor for using a complete Jacobian to calculate directional derivatives
     double jac_penalty_;
@@ -876,11 +976,23 @@ namespace casadi {
     static void print_stats_line(int maxNameLen, std::string label, double n_call,
       double t_proc, double t_wall);
   private:
-    /// Memory objects
-    mutable std::vector<void*> mem_;
+    /** \brief Memory objects
+        Stored in blocks of 1, 2, 4, ... objects. A block is never moved, so memory()
+        does not need to lock while other threads add memory objects.
+    */
+    mutable void** mem_[32];
+
+    /// Number of memory objects
+    mutable int nmem_;
 
     /// Unused memory objects
-    mutable std::stack<int> unused_;
+    mutable std::vector<int> unused_;
+
+    /// Protects nmem_ and unused_, locked only when compiled with WITH_THREAD
+    mutable std::mutex mem_mtx_;
+
+    /// Block in mem_ holding memory object ind
+    static int mem_block(int ind);
 
     /** \brief Memory that is persistent during a call (but not between calls) */
     size_t sz_arg_per_, sz_res_per_, sz_iw_per_, sz_w_per_;
@@ -1001,8 +1113,9 @@ namespace casadi {
     std::vector<D*> resp(sz_res());
     for (int i=0; i<n_out; ++i) resp[i]=get_ptr(res[i]);
 
-    // Call memory-less
-    _eval(get_ptr(argp), get_ptr(resp), get_ptr(iw_tmp), get_ptr(w_tmp), 0);
+    // Call with a memory object of its own
+    ScopedCheckout mem(this);
+    _eval(get_ptr(argp), get_ptr(resp), get_ptr(iw_tmp), get_ptr(w_tmp), mem);
   }
 
   template<typename M>
@@ -1012,6 +1012,7 @@ namespace casadi {
 
     // Default options
     nk_ = 20;
+    codegen_ = false;
   }
 
   FixedStepIntegrator::~FixedStepIntegrator() {
@@ -1022,7 +1023,14 @@ namespace casadi {
   = {{&Integrator::options_},
      {{"number_of_finite_elements",
        {OT_INT,
-        "Number of finite elements"}}
+        "Number of finite elements"}},
+      {"codegen",
+       {OT_BOOL,
+        "Reserve space in the work vector for the states and the backward tape, "
+        "so that the integrator can be code generated. Generated code always "
+        "solves linear systems with a symbolic QR factorization stored in arrays "
+        "on the stack, whatever the linear solver, which can overflow the stack "
+        "for large systems."}}
      }
   };
 
@@ -1034,6 +1042,8 @@ namespace casadi {
     for (auto&& op : opts) {
       if (op.first=="number_of_finite_elements") {
         nk_ = op.second;
+      } else if (op.first=="codegen") {
+        codegen_ = op.second;
       }
     }
 
@@ -1047,6 +1057,172 @@ namespace casadi {
     // Get discrete time dimensions
     nZ_ = F_.nnz_in(DAE_Z);
     nRZ_ =  G_.is_null() ? 0 : G_.nnz_in(RDAE_RZ);
+
+    // Work vector for generated code
+    if (codegen_) {
+      alloc_w(sz_w_codegen() + F_.sz_w());
+      if (!G_.is_null()) alloc_w(sz_w_codegen() + G_.sz_w());
+    }
+  }
+
+  size_t FixedStepIntegrator::sz_w_codegen() const {
+    // Time, current and previous states
+    size_t sz = 1 + 2*(nx_ + nZ_ + nq_ + nrx_ + nRZ_ + nrq_);
+
+    // Tape
+    if (nrx_>0) sz += (nk_+1)*nx_ + nk_*nZ_;
+    return sz;
+  }
+
+  void FixedStepIntegrator::generateDeclarations(CodeGenerator& g) const {
+    getExplicit()->addDependency(g);
+    if (nrx_>0) getExplicitB()->addDependency(g);
+  }
+
+  void FixedStepIntegrator::generateBody(CodeGenerator& g) const {
+    casadi_assert_message(codegen_, "Code generation of '" + name() + "' requires "
+                          "the option 'codegen'");
+    const Function& F = getExplicit();
+    casadi_assert_message(!g.simplifiedCall(F), "Not implemented.");
+    g.addAuxiliary(CodeGenerator::AUX_AXPY);
+
+    // Work vectors, same order as in sz_w_codegen
+    int off = 1;
+    g.body << "  int k;" << endl
+           << "  real_t *t=w";
+    const char* fwd[] = {"x", "x_prev", "Z", "Z_prev", "q", "q_prev"};
+    int fwd_sz[] = {nx_, nx_, nZ_, nZ_, nq_, nq_};
+    for (int i=0; i<6; ++i) {
+      g.body << ", *" << fwd[i] << "=w+" << off;
+      off += fwd_sz[i];
+    }
+    if (nrx_>0) {
+      const char* adj[] = {"rx", "rx_prev", "RZ", "RZ_prev", "rq", "rq_prev"};
+      int adj_sz[] = {nrx_, nrx_, nRZ_, nRZ_, nrq_, nrq_};
+      for (int i=0; i<6; ++i) {
+        g.body << ", *" << adj[i] << "=w+" << off;
+        off += adj_sz[i];
+      }
+      g.body << ", *x_tape=w+" << off;
+      off += (nk_+1)*nx_;
+      g.body << ", *Z_tape=w+" << off;
+      off += nk_*nZ_;
+    }
+    g.body << ";" << endl
+           << "  const real_t** arg1 = arg + " << n_in() << ";" << endl
+           << "  real_t** res1 = res + " << n_out() << ";" << endl;
+    casadi_assert(off==static_cast<int>(sz_w_codegen()));
+    string w1 = "w+" + g.to_string(off);
+
+    // Current time in the discrete time grid
+    string t0 = g.constant(grid_.front()), h = g.constant(h_);
+
+    // Reset the forward problem
+    string x0 = "arg[" + g.to_string(INTEGRATOR_X0) + "]";
+    string z0 = "arg[" + g.to_string(INTEGRATOR_Z0) + "]";
+    string p = "arg[" + g.to_string(INTEGRATOR_P) + "]";
+    g.body << "  *t = " << t0 << ";" << endl
+           << "  " << g.copy(x0, nx_, "x") << endl
+           << "  " << g.fill("q", nq_, "0.") << endl;
+    codegen_reset(g, "Z", x0, z0);
+    if (nrx_>0) g.body << "  " << g.copy("x", nx_, "x_tape") << endl;
+
+    // Integrate forward, one grid point at a time
+    int k = 0, ind = 0;
+    for (int j=0; j<grid_.size(); ++j) {
+      // Skip t0?
+      if (j==0 && !output_t0_) continue;
+
+      // Get discrete time sought, cf. advance
+      int k_out = std::ceil((grid_[j] - grid_.front())/h_);
+      k_out = std::min(k_out, nk_);
+
+      // Take time steps until end time has been reached
+      if (k<k_out) {
+        g.body << "  for (k=" << k << "; k<" << k_out << "; ++k) {" << endl
+               << "    " << g.copy("x", nx_, "x_prev") << endl
+               << "    " << g.copy("Z", nZ_, "Z_prev") << endl
+               << "    " << g.copy("q", nq_, "q_prev") << endl
+               << "    arg1[" << DAE_T << "] = t;" << endl
+               << "    arg1[" << DAE_X << "] = x_prev;" << endl
+               << "    arg1[" << DAE_Z << "] = Z_prev;" << endl
+               << "    arg1[" << DAE_P << "] = " << p << ";" << endl
+               << "    res1[" << DAE_ODE << "] = x;" << endl
+               << "    res1[" << DAE_ALG << "] = Z;" << endl
+               << "    res1[" << DAE_QUAD << "] = q;" << endl
+               << "    if (" << g(F, "arg1", "res1", "iw", w1) << ") return 1;" << endl
+               << "    axpy(" << nq_ << ", 1., q_prev, q);" << endl;
+        if (nrx_>0) {
+          g.body << "    " << g.copy("x", nx_, "x_tape+(k+1)*" + g.to_string(nx_)) << endl
+                 << "    " << g.copy("Z", nZ_, "Z_tape+k*" + g.to_string(nZ_)) << endl;
+        }
+        g.body << "    *t = " << t0 << "+(k+1)*" << h << ";" << endl
+               << "  }" << endl;
+        k = k_out;
+      }
+
+      // Return to user
+      const int out[] = {INTEGRATOR_XF, INTEGRATOR_ZF, INTEGRATOR_QF};
+      const string val[] = {"x", "Z+" + g.to_string(nZ_-nz_), "q"};
+      int val_sz[] = {nx_, nz_, nq_};
+      for (int i=0; i<3; ++i) {
+        if (val_sz[i]==0) continue;
+        string r = "res[" + g.to_string(out[i]) + "]";
+        g.body << "  if (" << r << ") "
+               << g.copy(val[i], val_sz[i], r + "+" + g.to_string(ind*val_sz[i])) << endl;
+      }
+      ind++;
+    }
+
+    // If backwards integration is needed
+    if (nrx_>0) {
+      const Function& G = getExplicitB();
+      casadi_assert_message(!g.simplifiedCall(G), "Not implemented.");
+
+      // Reset the backward problem
+      string rx0 = "arg[" + g.to_string(INTEGRATOR_RX0) + "]";
+      string rz0 = "arg[" + g.to_string(INTEGRATOR_RZ0) + "]";
+      string rp = "arg[" + g.to_string(INTEGRATOR_RP) + "]";
+      g.body << "  " << g.copy(rx0, nrx_, "rx") << endl
+             << "  " << g.fill("rq", nrq_, "0.") << endl;
+      codegen_resetB(g, "RZ", rx0, rz0);
+
+      // Proceed to t0, cf. retreat
+      g.body << "  for (k=" << (nk_-1) << "; k>=0; --k) {" << endl
+             << "    *t = " << t0 << "+k*" << h << ";" << endl
+             << "    " << g.copy("rx", nrx_, "rx_prev") << endl
+             << "    " << g.copy("RZ", nRZ_, "RZ_prev") << endl
+             << "    " << g.copy("rq", nrq_, "rq_prev") << endl
+             << "    arg1[" << RDAE_RX << "] = rx_prev;" << endl
+             << "    arg1[" << RDAE_RZ << "] = RZ_prev;" << endl
+             << "    arg1[" << RDAE_RP << "] = " << rp << ";" << endl
+             << "    arg1[" << RDAE_X << "] = x_tape+k*" << nx_ << ";" << endl
+             << "    arg1[" << RDAE_Z << "] = Z_tape+k*" << nZ_ << ";" << endl
+             << "    arg1[" << RDAE_P << "] = " << p << ";" << endl
+             << "    arg1[" << RDAE_T << "] = t;" << endl
+             << "    res1[" << RDAE_ODE << "] = rx;" << endl
+             << "    res1[" << RDAE_ALG << "] = RZ;" << endl
+             << "    res1[" << RDAE_QUAD << "] = rq;" << endl
+             << "    if (" << g(G, "arg1", "res1", "iw", w1) << ") return 1;" << endl
+             << "    axpy(" << nrq_ << ", 1., rq_prev, rq);" << endl
+             << "  }" << endl;
+
+      // Return to user
+      g.body << "  " << g.copy("rx", nrx_, "res[" + g.to_string(INTEGRATOR_RXF) + "]") << endl
+             << "  " << g.copy("RZ+" + g.to_string(nRZ_-nrz_), nrz_,
+                               "res[" + g.to_string(INTEGRATOR_RZF) + "]") << endl
+             << "  " << g.copy("rq", nrq_, "res[" + g.to_string(INTEGRATOR_RQF) + "]") << endl;
+    }
+  }
+
+  void FixedStepIntegrator::codegen_reset(CodeGenerator& g, const std::string& Z,
+                                          const std::string& x, const std::string& z) const {
+    g.body << "  " << g.fill(Z, nZ_, "NAN") << endl;
+  }
+
+  void FixedStepIntegrator::codegen_resetB(CodeGenerator& g, const std::string& RZ,
+                                           const std::string& rx, const std::string& rz) const {
+    g.body << "  " << g.fill(RZ, nRZ_, "NAN") << endl;
   }
 
   void FixedStepIntegrator::init_memory(void* mem) const {
@@ -1106,6 +1282,7 @@ namespace casadi {
     m->res[DAE_QUAD] = get_ptr(m->q);
 
     // Take time steps until end time has been reached
+    ScopedCheckout F_mem(F);
     while (m->k<k_out) {
       // Update the previous step
       casadi_copy(get_ptr(m->x), nx_, get_ptr(m->x_prev));
@@ -1113,7 +1290,7 @@ namespace casadi {
       casadi_copy(get_ptr(m->q), nq_, get_ptr(m->q_prev));
 
       // Take step
-      F(m->arg, m->res, m->iw, m->w, 0);
+      F(m->arg, m->res, m->iw, m->w, F_mem);
       casadi_axpy(nq_, 1., get_ptr(m->q_prev), get_ptr(m->q));
 
       // Tape
@@ -1160,6 +1337,7 @@ namespace casadi {
     m->res[RDAE_QUAD] = get_ptr(m->rq);
 
     // Take time steps until end time has been reached
+    ScopedCheckout G_mem(G);
     while (m->k>k_out) {
       // Advance time
       m->k--;
@@ -1173,7 +1351,7 @@ namespace casadi {
       // Take step
       m->arg[RDAE_X] = get_ptr(m->x_tape.at(m->k));
       m->arg[RDAE_Z] = get_ptr(m->Z_tape.at(m->k));
-      G(m->arg, m->res, m->iw, m->w, 0);
+      G(m->arg, m->res, m->iw, m->w, G_mem);
       casadi_axpy(nrq_, 1., get_ptr(m->rq_prev), get_ptr(m->rq));
     }
 
@@ -1281,6 +1459,7 @@ namespace casadi {
     rootfinder_ = rootfinder(name_ + "_rootfinder", implicit_function_name,
                                   F_, rootfinder_options);
     alloc(rootfinder_);
+    if (codegen_) alloc_w(sz_w_codegen() + rootfinder_.sz_w());
 
     // Allocate a root-finding solver for the backward problem
     if (nRZ_>0) {
@@ -1296,6 +1475,7 @@ namespace casadi {
                    backward_implicit_function_name,
                    G_, backward_rootfinder_options);
       alloc(backward_rootfinder_);
+      if (codegen_) alloc_w(sz_w_codegen() + backward_rootfinder_.sz_w());
     }
   }
 
@@ -291,6 +291,26 @@ namespace casadi {
     /// Get explicit dynamics (backward problem)
     virtual const Function& getExplicitB() const { return G_;}
 
+    /** \brief Is codegen supported? */
+    virtual bool has_codegen() const { return codegen_;}
+
+    /** \brief Generate code for the declarations of the C function */
+    virtual void generateDeclarations(CodeGenerator& g) const;
+
+    /** \brief Generate code for the body of the C function */
+    virtual void generateBody(CodeGenerator& g) const;
+
+    /// Generate code for the initial guess of the discrete time algebraic variables
+    virtual void codegen_reset(CodeGenerator& g, const std::string& Z,
+                               const std::string& x, const std::string& z) const;
+
+    /// Generate code for the initial guess, backward problem
+    virtual void codegen_resetB(CodeGenerator& g, const std::string& RZ,
+                                const std::string& rx, const std::string& rz) const;
+
+    /// Length of the work vector used for the states and the tape in generated code
+    size_t sz_w_codegen() const;
+
     // Discrete time dynamics
     Function F_, G_;
 
@@ -302,6 +322,9 @@ namespace casadi {
 
     /// Number of algebraic variables for the discrete time integration
     int nZ_, nRZ_;
+
+    /// Reserve work space for generated code
+    bool codegen_;
   };
 
   class CASADI_EXPORT ImplicitFixedStepIntegrator : public FixedStepIntegrator {
@@ -71,18 +71,21 @@ namespace casadi {
       "Linsol::solve: Dimension mismatch. A and b must have matching row count." <<
       " Got " << A.dim() << " and " << B.dim() << ".");
 
+    // Memory object, not shared with concurrent calls
+    ScopedCheckout mem(operator->());
+
     // Set sparsity
-    reset(A.sparsity());
+    reset(A.sparsity(), mem);
 
     // Calculate partial pivots
-    pivoting(A.ptr());
+    pivoting(A.ptr(), mem);
 
     // Factorize
-    factorize(A.ptr());
+    factorize(A.ptr(), mem);
 
     // Solve
     DM x = densify(B);
-    solve(x.ptr(), x.size2());
+    solve(x.ptr(), x.size2(), false, mem);
     return x;
   }
 
@@ -90,13 +93,13 @@ namespace casadi {
     return A->getSolve(B, tr, *this);
   }
 
-  void Linsol::solve_cholesky(double* x, int nrhs, bool tr) const {
-    (*this)->solve_cholesky((*this)->memory(0), x, nrhs, tr);
+  void Linsol::solve_cholesky(double* x, int nrhs, bool tr, int mem) const {
+    (*this)->solve_cholesky((*this)->memory(mem), x, nrhs, tr);
   }
 
-  void Linsol::reset(const int* sp) const {
+  void Linsol::reset(const int* sp, int mem) const {
     casadi_assert(sp!=0);
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
 
     // Check if pattern has changed
     bool changed_pattern = m->sparsity.empty();
@@ -119,9 +122,9 @@ namespace casadi {
     }
   }
 
-  void Linsol::pivoting(const double* A) const {
+  void Linsol::pivoting(const double* A, int mem) const {
     casadi_assert(A!=0);
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert_message(!m->sparsity.empty(), "No sparsity pattern set");
 
     // Factorization will be needed after this step
@@ -134,42 +137,50 @@ namespace casadi {
     m->is_pivoted = true;
   }
 
-  void Linsol::factorize(const double* A) const {
+  void Linsol::factorize(const double* A, int mem) const {
     casadi_assert(A!=0);
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
 
     // Perform pivoting, if required
-    if (!m->is_pivoted) pivoting(A);
+    if (!m->is_pivoted) pivoting(A, mem);
 
     m->is_factorized = false;
     (*this)->factorize(m, A);
     m->is_factorized = true;
   }
 
-  int Linsol::neig() const {
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+  int Linsol::neig(int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert(m->is_factorized);
     return (*this)->neig(m);
   }
 
-  int Linsol::rank() const {
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+  int Linsol::rank(int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert(m->is_factorized);
     return (*this)->rank(m);
   }
 
-  void Linsol::solve(double* x, int nrhs, bool tr) const {
-    auto m = static_cast<LinsolMemory*>((*this)->memory(0));
+  void Linsol::solve(double* x, int nrhs, bool tr, int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
     casadi_assert_message(m->is_factorized, "Linear system has not been factorized");
     (*this)->solve(m, x, nrhs, tr);
   }
 
-  Sparsity Linsol::cholesky_sparsity(bool tr) const {
-    return (*this)->linsol_cholesky_sparsity((*this)->memory(0), tr);
+  Sparsity Linsol::cholesky_sparsity(bool tr, int mem) const {
+    return (*this)->linsol_cholesky_sparsity((*this)->memory(mem), tr);
+  }
+
+  DM Linsol::cholesky(bool tr, int mem) const {
+    return (*this)->linsol_cholesky((*this)->memory(mem), tr);
+  }
+
+  int Linsol::checkout() const {
+    return (*this)->checkout();
   }
 
-  DM Linsol::cholesky(bool tr) const {
-    return (*this)->linsol_cholesky((*this)->memory(0), tr);
+  void Linsol::release(int mem) const {
+    (*this)->release(mem);
   }
 
 } // namespace casadi
@@ -47,6 +47,18 @@ namespace casadi {
     // Call the base class initializer
     FunctionInternal::init(opts);
 
+    // Keep the options for comparison with other instances
+    opts_ = opts;
+  }
+
+  bool LinsolInternal::is_equivalent(const LinsolInternal& other) const {
+    if (this==&other) return true;
+    if (string(plugin_name())!=other.plugin_name()) return false;
+    if (opts_.size()!=other.opts_.size()) return false;
+    for (auto i=opts_.begin(), j=other.opts_.begin(); i!=opts_.end(); ++i, ++j) {
+      if (i->first!=j->first || i->second!=j->second) return false;
+    }
+    return true;
   }
 
   void LinsolInternal::init_memory(void* mem) const {
@@ -112,6 +124,138 @@ namespace casadi {
     casadi_error("'rank' not defined for " + type_name());
   }
 
+  void LinsolInternal::qr_functions(const Sparsity& sp, Function& fact, Function& solv,
+                                    Function& solv_tr, const Dict& opts) {
+    // Symbolic expression for A
+    SX A = SX::sym("A", sp);
+
+    // BTF factorization
+    const Sparsity::Btf& btf = sp.btf();
+
+    // Get the inverted column permutation
+    std::vector<int> inv_colperm(btf.colperm.size());
+    for (int k=0; k<btf.colperm.size(); ++k)
+      inv_colperm[btf.colperm[k]] = k;
+
+    // Get the inverted row permutation
+    std::vector<int> inv_rowperm(btf.rowperm.size());
+    for (int k=0; k<btf.rowperm.size(); ++k)
+      inv_rowperm[btf.rowperm[k]] = k;
+
+    // Permute the linear system
+    SX Aperm = A(btf.rowperm, btf.colperm);
+
+    // Generate the QR factorization function
+    SX Q1, R1;
+    qr(Aperm, Q1, R1);
+    fact = Function("QR_fact", {A}, {Q1, R1}, opts);
+
+    // Symbolic expressions for solve function
+    SX Q = SX::sym("Q", Q1.sparsity());
+    SX R = SX::sym("R", R1.sparsity());
+    SX b = SX::sym("b", sp.size2(), 1);
+
+    // Solve non-transposed
+    // We have Pb' * Q * R * Px * x = b <=> x = Px' * inv(R) * Q' * Pb * b
+
+    // Permute the right hand sides
+    SX bperm = b(btf.rowperm, Slice());
+
+    // Solve the factorized system
+    SX xperm = SX::solve(R, mtimes(Q.T(), bperm));
+
+    // Permute back the solution
+    SX x = xperm(inv_colperm, Slice());
+
+    // Generate the QR solve function
+    vector<SX> solv_in = {Q, R, b};
+    solv = Function("QR_solv", solv_in, {x}, opts);
+
+    // Solve transposed
+    // We have (Pb' * Q * R * Px)' * x = b
+    // <=> Px' * R' * Q' * Pb * x = b
+    // <=> x = Pb' * Q * inv(R') * Px * b
+
+    // Permute the right hand side
+    bperm = b(btf.colperm, Slice());
+
+    // Solve the factorized system
+    xperm = mtimes(Q, SX::solve(R.T(), bperm));
+
+    // Permute back the solution
+    x = xperm(inv_rowperm, Slice());
+
+    // Mofify the QR solve function
+    solv_tr = Function("QR_solv_T", solv_in, {x}, opts);
+  }
+
+  const std::vector<Function>& LinsolInternal::qr_codegen(const Sparsity& sp) const {
+    // Already created?
+    for (auto&& e : qr_codegen_) {
+      if (e.first.is_equal(sp)) return e.second;
+    }
+
+    // Create factorization and solve functions
+    vector<Function> f(3);
+    qr_functions(sp, f[0], f[1], f[2]);
+    qr_codegen_.push_back(make_pair(sp, f));
+    return qr_codegen_.back().second;
+  }
+
+  void LinsolInternal::codegen_declarations(CodeGenerator& g, const Sparsity& sp) const {
+    for (auto&& f : qr_codegen(sp)) f->addDependency(g);
+  }
+
+  void LinsolInternal::codegen_solve(CodeGenerator& g, const Sparsity& sp, const std::string& A,
+                                     const std::vector<std::string>& x,
+                                     const std::vector<int>& nrhs,
+                                     const std::vector<bool>& tr) const {
+    casadi_assert(x.size()==nrhs.size() && x.size()==tr.size());
+    const vector<Function>& f = qr_codegen(sp);
+    int n = sp.size1();
+
+    // Work vector sizes of the factorization and the solves
+    size_t sz_arg=0, sz_res=0, sz_iw=0, sz_w=0;
+    for (auto&& fk : f) {
+      sz_arg = max(sz_arg, fk.sz_arg());
+      sz_res = max(sz_res, fk.sz_res());
+      sz_iw = max(sz_iw, fk.sz_iw());
+      sz_w = max(sz_w, fk.sz_w());
+    }
+
+    // Local variables
+    g.body << "  {" << endl
+           << "    int qr_k;" << endl
+           << "    " << g.array("const real_t*", "qr_arg", sz_arg)
+           << "    " << g.array("real_t*", "qr_res", sz_res)
+           << "    " << g.array("int", "qr_iw", sz_iw)
+           << "    " << g.array("real_t", "qr_q", f[0].nnz_out(0))
+           << "    " << g.array("real_t", "qr_r", f[0].nnz_out(1))
+           << "    " << g.array("real_t", "qr_w", n + sz_w);
+
+    // Factorize
+    g.body << "    qr_arg[0] = " << A << ";" << endl
+           << "    qr_res[0] = qr_q;" << endl
+           << "    qr_res[1] = qr_r;" << endl
+           << "    if (" << g(f[0], "qr_arg", "qr_res", "qr_iw", "qr_w") << ") return 1;" << endl;
+
+    // Solve for all right-hand-sides, using qr_w as a temporary
+    g.body << "    qr_arg[0] = qr_q;" << endl
+           << "    qr_arg[1] = qr_r;" << endl
+           << "    qr_arg[2] = qr_w;" << endl;
+    for (int i=0; i<x.size(); ++i) {
+      if (nrhs[i]==0) continue;
+      string xk = x[i] + "+qr_k*" + g.to_string(n);
+      g.body << "    for (qr_k=0; qr_k<" << nrhs[i] << "; ++qr_k) {" << endl
+             << "      " << g.copy(xk, n, "qr_w") << endl
+             << "      qr_res[0] = " << xk << ";" << endl
+             << "      if (" << g(f[tr[i] ? 2 : 1], "qr_arg", "qr_res", "qr_iw",
+                                  "qr_w+" + g.to_string(n)) << ") return 1;" << endl
+             << "    }" << endl;
+    }
+    g.body << "  }" << endl;
+  }
+
   std::map<std::string, LinsolInternal::Plugin> LinsolInternal::solvers_;
 
   const std::string LinsolInternal::infix_ = "linsol";
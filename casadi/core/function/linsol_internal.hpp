@@ -113,6 +113,23 @@ namespace casadi {
     /// Matrix rank
     virtual int rank(void* mem) const;
 
+    /** \brief Create functions for a symbolic QR factorization and the (transposed) solve
+        The factorization maps A to (Q, R), the solves map (Q, R, b) to x
+    */
+    static void qr_functions(const Sparsity& sp, Function& fact, Function& solv,
+                             Function& solv_tr, const Dict& opts=Dict());
+
+    /** \brief Add the functions needed to generate code for a given sparsity pattern */
+    void codegen_declarations(CodeGenerator& g, const Sparsity& sp) const;
+
+    /** \brief Generate code for factorizing A and solving for x in place
+        The linear system is solved with a symbolic QR factorization, regardless of
+        the plugin. Factors and work vectors are declared on the stack.
+    */
+    void codegen_solve(CodeGenerator& g, const Sparsity& sp, const std::string& A,
+                       const std::vector<std::string>& x, const std::vector<int>& nrhs,
+                       const std::vector<bool>& tr) const;
+
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name);
 
@@ -127,6 +144,19 @@ namespace casadi {
 
     // Get name of the plugin
     virtual const char* plugin_name() const = 0;
+
+    /** \brief Same plugin and options, so that either instance can be used */
+    bool is_equivalent(const LinsolInternal& other) const;
+
+    /// Options the instance was created with
+    Dict opts_;
+
+  protected:
+    /// Get the QR functions for code generation, created the first time a pattern is seen
+    const std::vector<Function>& qr_codegen(const Sparsity& sp) const;
+
+    /// QR functions for code generation, must outlive the code generator
+    mutable std::vector<std::pair<Sparsity, std::vector<Function> > > qr_codegen_;
   };
 
 
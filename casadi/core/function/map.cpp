@@ -24,6 +24,17 @@
 
 
 #include "map.hpp"
+#include "sx_function.hpp"
+
+// Number of instances evaluated together in MapSimd, filling an AVX2 or AVX-512 register
+#ifdef __AVX512F__
+#define CASADI_MAP_SIMD_LANES 8
+#else // __AVX512F__
+#define CASADI_MAP_SIMD_LANES 4
+#endif // __AVX512F__
+
+// Number of instances passed to the batched variant of the inner function in generated code
+#define CASADI_MAP_BATCH 64
 
 using namespace std;
 
@@ -38,6 +49,8 @@ namespace casadi {
       ret.assignNode(new Map(name, f, n));
     } else if (parallelization== "openmp") {
       ret.assignNode(new MapOmp(name, f, n));
+    } else if (parallelization== "simd") {
+      ret.assignNode(new MapSimd(name, f, n));
     } else {
       casadi_error("Unknown parallelization: " + parallelization);
     }
@@ -48,20 +61,56 @@ namespace casadi {
 
   Map::Map(const std::string& name, const Function& f, int n)
     : FunctionInternal(name), f_(f), n_(n) {
+    codegen_batch_ = false;
   }
 
   Map::~Map() {
   }
 
+  Options Map::options_
+  = {{&FunctionInternal::options_},
+     {{"codegen_batch",
+       {OT_BOOL,
+        "Call the batched variant of an SX inner function in code generated with "
+        "the 'batch' option, " + to_string(CASADI_MAP_BATCH) + " instances at a time. "
+        "Reserves work space for the transposed inputs and outputs."}}
+     }
+  };
+
   void Map::init(const Dict& opts) {
     // Call the initialization method of the base class
     FunctionInternal::init(opts);
 
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="codegen_batch") {
+        codegen_batch_ = op.second;
+      }
+    }
+
     // Allocate sufficient memory for serial evaluation
     alloc_arg(f_.sz_arg());
     alloc_res(f_.sz_res());
     alloc_w(f_.sz_w());
     alloc_iw(f_.sz_iw());
+
+    // Generated code transposes the inputs and outputs for the batched variant
+    if (codegen_batch_ && f_->has_batch()) {
+      int nnz = 0;
+      for (int i=0; i<n_in(); ++i) nnz += f_.nnz_in(i);
+      for (int i=0; i<n_out(); ++i) nnz += f_.nnz_out(i);
+      alloc_w(CASADI_MAP_BATCH*nnz + f_.sz_w());
+    }
+  }
+
+  Dict Map::derived_options() const {
+    Dict opts = FunctionInternal::derived_options();
+    opts["codegen_batch"] = codegen_batch_;
+    return opts;
+  }
+
+  bool Map::codegen_batch(const CodeGenerator& g) const {
+    return codegen_batch_ && g.batch && f_->has_batch();
   }
 
   template<typename T>
@@ -71,8 +120,9 @@ namespace casadi {
     copy_n(arg, n_in, arg1);
     T** res1 = res+n_out;
     copy_n(res, n_out, res1);
+    ScopedCheckout mem(f_);
     for (int i=0; i<n_; ++i) {
-      f_(arg1, res1, iw, w, 0);
+      f_(arg1, res1, iw, w, mem);
       for (int j=0; j<n_in; ++j) {
         if (arg1[j]) arg1[j] += f_.nnz_in(j);
       }
@@ -108,10 +158,15 @@ namespace casadi {
   }
 
   void Map::generateDeclarations(CodeGenerator& g) const {
-    f_->addDependency(g);
+    if (codegen_batch(g)) {
+      f_->addBatchDependency(g);
+    } else {
+      f_->addDependency(g);
+    }
   }
 
   void Map::generateBody(CodeGenerator& g) const {
+    if (codegen_batch(g)) return generate_batch(g);
     int n_in = this->n_in(), n_out = this->n_out();
     g.body << "  int i;" << endl;
     // Input buffer
@@ -136,6 +191,49 @@ namespace casadi {
     g.body << "  }" << std::endl;
   }
 
+  void Map::generate_batch(CodeGenerator& g) const {
+    int n_in = this->n_in(), n_out = this->n_out();
+    g.body << "  int i, j, k, nb;" << endl
+           << "  const real_t** arg1 = arg+" << n_in << ";" << endl
+           << "  real_t** res1 = res+" << n_out << ";" << endl
+           << "  for (i=0; i<" << n_ << "; i+=" << CASADI_MAP_BATCH << ") {" << endl
+           << "    nb = " << n_ << "-i<" << CASADI_MAP_BATCH << " ? "
+           << n_ << "-i : " << CASADI_MAP_BATCH << ";" << endl;
+
+    // Inputs in structure-of-arrays layout, at the beginning of the work vector
+    int off = 0;
+    vector<int> off_out(n_out);
+    for (int j=0; j<n_in; ++j) {
+      int nnz = f_.nnz_in(j);
+      g.body << "    arg1[" << j << "] = arg[" << j << "] ? w+" << off << " : 0;" << endl;
+      if (nnz>0) {
+        g.body << "    if (arg[" << j << "]) for (k=0; k<nb; ++k) for (j=0; j<" << nnz
+               << "; ++j) w[" << off << "+j*nb+k] = arg[" << j << "][(i+k)*" << nnz
+               << "+j];" << endl;
+      }
+      off += CASADI_MAP_BATCH*nnz;
+    }
+    for (int j=0; j<n_out; ++j) {
+      g.body << "    res1[" << j << "] = res[" << j << "] ? w+" << off << " : 0;" << endl;
+      off_out[j] = off;
+      off += CASADI_MAP_BATCH*f_.nnz_out(j);
+    }
+
+    // Evaluate the batch
+    g.body << "    if (" << f_->codegen_batch_name(g) << "(arg1, res1, iw, w+" << off
+           << ", nb)) return 1;" << endl;
+
+    // Outputs back to the instance-by-instance layout
+    for (int j=0; j<n_out; ++j) {
+      int nnz = f_.nnz_out(j);
+      if (nnz==0) continue;
+      g.body << "    if (res[" << j << "]) for (k=0; k<nb; ++k) for (j=0; j<" << nnz
+             << "; ++j) res[" << j << "][(i+k)*" << nnz << "+j] = w[" << off_out[j]
+             << "+j*nb+k];" << endl;
+    }
+    g.body << "  }" << endl;
+  }
+
   Function Map
   ::get_forward(const std::string& name, int nfwd,
                 const std::vector<std::string>& i_names,
@@ -324,4 +422,87 @@ namespace casadi {
     alloc_iw(f_.sz_iw() * n_);
   }
 
+  MapSimd::~MapSimd() {
+  }
+
+  void MapSimd::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    Map::init(opts);
+
+    // Lane batching requires an interpreted SXFunction without free variables
+    simd_ = f_.is_a("sxfunction") && !f_.has_free() && f_->eval_==0 && f_->simple_==0;
+
+    if (simd_) {
+      // Nonzeros per instance
+      nnz_in_.resize(n_in());
+      for (int i=0; i<nnz_in_.size(); ++i) nnz_in_[i] = f_.nnz_in(i);
+      nnz_out_.resize(n_out());
+      for (int i=0; i<nnz_out_.size(); ++i) nnz_out_[i] = f_.nnz_out(i);
+
+      // Work vector in structure-of-arrays layout, one element per lane
+      alloc_w(f_.sz_w() * CASADI_MAP_SIMD_LANES);
+    }
+
+    if (verbose()) {
+      if (simd_) {
+        log("MapSimd::init", "Evaluating " + f_.name() + " in batches of "
+            + to_string(CASADI_MAP_SIMD_LANES) + " lanes");
+      } else {
+        log("MapSimd::init", "Falling back to serial evaluation of " + f_.name());
+      }
+    }
+  }
+
+  template<int W>
+  void MapSimd::eval_lanes(const double** arg, double** res, double* w, int offset) const {
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    int k;
+    for (auto&& e : f->algorithm_) {
+      double* w0 = w + e.i0*W;
+      switch (e.op) {
+        CASADI_MATH_FUN_BUILTIN_GEN(BinaryOperationVV, w + e.i1*W, w + e.i2*W, w0, W)
+      case OP_CONST:
+        for (k=0; k<W; ++k) w0[k] = e.d;
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]==0) {
+          for (k=0; k<W; ++k) w0[k] = 0;
+        } else {
+          const double* a = arg[e.i1] + offset*nnz_in_[e.i1] + e.i2;
+          for (k=0; k<W; ++k) w0[k] = a[k*nnz_in_[e.i1]];
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=0) {
+          double* r = res[e.i0] + offset*nnz_out_[e.i0] + e.i2;
+          const double* w1 = w + e.i1*W;
+          for (k=0; k<W; ++k) r[k*nnz_out_[e.i0]] = w1[k];
+        }
+        break;
+      default:
+        casadi_error("MapSimd::eval: Unknown operation" << e.op);
+      }
+    }
+  }
+
+  void MapSimd::eval(void* mem, const double** arg, double** res, int* iw, double* w) const {
+    if (!simd_) return Map::eval(mem, arg, res, iw, w);
+
+    // Evaluate full batches
+    int i;
+    for (i=0; i+CASADI_MAP_SIMD_LANES<=n_; i+=CASADI_MAP_SIMD_LANES) {
+      eval_lanes<CASADI_MAP_SIMD_LANES>(arg, res, w, i);
+    }
+
+    // Evaluate the remaining instances one at a time
+    for (; i<n_; ++i) eval_lanes<1>(arg, res, w, i);
+  }
+
+  Dict MapSimd::get_stats(void* mem) const {
+    Dict stats = Map::get_stats(mem);
+    stats["simd"] = simd_;
+    stats["simd_lanes"] = simd_ ? CASADI_MAP_SIMD_LANES : 1;
+    return stats;
+  }
+
 } // namespace casadi
@@ -102,9 +102,24 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     virtual void generateBody(CodeGenerator& g) const;
 
+    /** \brief Call the batched variant of the inner function in generated code? */
+    virtual bool codegen_batch(const CodeGenerator& g) const;
+
+    /** \brief Generate code calling the batched variant of the inner function */
+    void generate_batch(CodeGenerator& g) const;
+
+    ///@{
+    /** \brief Options */
+    static Options options_;
+    virtual const Options& get_options() const { return options_;}
+    ///@}
+
     /** \brief  Initialize */
     virtual void init(const Dict& opts);
 
+    /** \brief Get options for derived functions */
+    virtual Dict derived_options() const;
+
     ///@{
     /** \brief Generate a function that calculates \a nfwd forward derivatives */
     virtual Function get_forward(const std::string& name, int nfwd,
@@ -132,6 +147,9 @@ namespace casadi {
 
     // Number of times to evaluate this function
     int n_;
+
+    // Call the batched variant of the inner function in generated code
+    bool codegen_batch_;
   };
 
   /** A map Evaluate in parallel using OpenMP
@@ -161,6 +179,47 @@ namespace casadi {
 
     /** \brief Generate code for the body of the C function */
     virtual void generateBody(CodeGenerator& g) const;
+
+    /** \brief Instances are evaluated by separate calls */
+    virtual bool codegen_batch(const CodeGenerator& g) const { return false;}
+  };
+
+  /** A map evaluated with lane batching of the SX virtual machine
+      Instead of calling the inner function n times, the instruction list of an
+      inner SXFunction is traversed once for every batch of lanes, with the work
+      vector stored in a structure-of-arrays layout. If the inner function is not
+      an SXFunction, the evaluation falls back to serial evaluation.
+  */
+  class CASADI_EXPORT MapSimd : public Map {
+    friend class Map;
+  protected:
+    // Constructor (protected, use create function in Map)
+    MapSimd(const std::string& name, const Function& f, int n) : Map(name, f, n) {}
+
+    /** \brief  Destructor */
+    virtual ~MapSimd();
+
+    /// Evaluate the function numerically
+    virtual void eval(void* mem, const double** arg, double** res, int* iw, double* w) const;
+
+    /** \brief  Initialize */
+    virtual void init(const Dict& opts);
+
+    /// Type of parallellization
+    virtual std::string parallelization() const { return "simd"; }
+
+    /// Get all statistics
+    virtual Dict get_stats(void* mem) const;
+
+    /// Evaluate a batch of lanes starting with instance \a offset
+    template<int W>
+    void eval_lanes(const double** arg, double** res, double* w, int offset) const;
+
+    /// Is the lane-batched evaluation used?
+    bool simd_;
+
+    /// Number of nonzeros in each input and output of the inner function
+    std::vector<int> nnz_in_, nnz_out_;
   };
 
 } // namespace casadi
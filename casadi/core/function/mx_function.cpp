@@ -27,6 +27,7 @@
 #include "../casadi_types.hpp"
 #include "../global_options.hpp"
 #include "../casadi_interrupt.hpp"
+#include "../mx/getnonzeros.hpp"
 
 #include <stack>
 #include <typeinfo>
@@ -39,6 +40,9 @@ namespace casadi {
                          const std::vector<MX>& inputv,
                          const std::vector<MX>& outputv) :
     XFunction<MXFunction, MX, MXNode>(name, inputv, outputv) {
+    parallel_ = false;
+    merge_solves_ = false;
+    n_lanes_ = 0;
   }
 
 
@@ -52,7 +56,23 @@ namespace casadi {
         "Default input values"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"parallelization",
+       {OT_STRING,
+        "Evaluate independent function calls in parallel: "
+        "serial (default)|openmp"}},
+      {"cse",
+       {OT_BOOL,
+        "Merge identical subexpressions, including function calls and "
+        "linear solves, before sorting the algorithm"}},
+      {"reorder_mtimes",
+       {OT_BOOL,
+        "Rebuild chains of matrix products with the parenthesization that "
+        "minimizes the estimated number of multiply-adds"}},
+      {"merge_solves",
+       {OT_BOOL,
+        "Merge linear solves and inverses with the same matrix, transposed or not, "
+        "so that the matrix is factorized only once"}}
      }
   };
 
@@ -64,6 +84,8 @@ namespace casadi {
 
     // Default (temporary) options
     bool live_variables = true;
+    bool cse = false;
+    bool reorder_mtimes = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -71,9 +93,23 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables = op.second;
+      } else if (op.first=="cse") {
+        cse = op.second;
+      } else if (op.first=="reorder_mtimes") {
+        reorder_mtimes = op.second;
+      } else if (op.first=="merge_solves") {
+        merge_solves_ = op.second;
+      } else if (op.first=="parallelization") {
+        string parallelization = op.second;
+        casadi_assert_message(parallelization=="serial" || parallelization=="openmp",
+                              "Unknown parallelization: " + parallelization);
+        parallel_ = parallelization=="openmp";
       }
     }
 
+    // Nodes evaluated concurrently must not share work vector elements
+    if (parallel_) live_variables = false;
+
     // Check/set default inputs
     if (default_in_.empty()) {
       default_in_.resize(n_in(), 0);
@@ -82,6 +118,12 @@ namespace casadi {
                             "Option 'default_in' has incorrect length");
     }
 
+    // Reorder chains of matrix products
+    if (reorder_mtimes) out_ = MX::reorder_mtimes(out_);
+
+    // Share factorizations between linear solves, identical matrices must be the same node
+    if (merge_solves_) out_ = MX::merge_solves(cse ? MX::cse(out_) : out_);
+
     // Stack used to sort the computational graph
     stack<MXNode*> s;
 
@@ -99,6 +141,24 @@ namespace casadi {
       nodes.push_back(static_cast<MXNode*>(0));
     }
 
+    // Merge identical subexpressions and sort again
+    if (cse) {
+      for (auto&& n : nodes) if (n) n->temp = 0;
+      out_ = MX::cse(out_);
+      int n_removed = nodes.size();
+      nodes.clear();
+      for (auto&& e : out_) {
+        s.push(static_cast<MXNode*>(e.get()));
+        sort_depth_first(s, nodes);
+        nodes.push_back(static_cast<MXNode*>(0));
+      }
+      n_removed -= nodes.size();
+      if (verbose()) {
+        userOut() << "MXFunction::init: common subexpression elimination removed "
+                  << n_removed << " nodes" << endl;
+      }
+    }
+
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
@@ -200,9 +260,33 @@ namespace casadi {
     // Work vector size
     int worksize = 0;
 
+    // Nodes whose result shares storage with a part of another node, with nonzero offset
+    vector<int> view_node(nodes.size(), -1), view_nz(nodes.size(), 0);
+
+    // Slots in the work vector that share storage with another slot, with nonzero offset
+    view_base_.clear();
+    view_offset_.clear();
+
     // Find a place in the work vector for the operation
     for (auto it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
 
+      // Results that are a contiguous part of the first argument keep it alive
+      if (it->op!=OP_OUTPUT) {
+        for (int c=0; c<it->res.size(); ++c) {
+          int offset = it->data->view_offset(c);
+          if (it->res[c]<0 || offset<0 || it->data->sparsity(c).nnz()<=1) continue;
+          int base = it->arg[0];
+          if (view_node[base]>=0) {
+            offset += view_nz[base];
+            base = view_node[base];
+          }
+          if (nodes[base]->sparsity().nnz()<=1) continue;
+          view_node[it->res[c]] = base;
+          view_nz[it->res[c]] = offset;
+          refcount[base]++;
+        }
+      }
+
       // There are two tasks, allocate memory of the result and free the
       // memory off the arguments, order depends on whether inplace is possible
       int first_to_free = 0;
@@ -222,14 +306,21 @@ namespace casadi {
             // unused variables if the count hits zero
             int remaining = --refcount[ch_ind];
 
+            // A view that is no longer needed releases the node it refers to
+            int freed = ch_ind;
+            if (remaining==0 && view_node[ch_ind]>=0) {
+              freed = view_node[ch_ind];
+              remaining = --refcount[freed];
+            }
+
             // Free variable for reuse
             if (live_variables && remaining==0) {
 
               // Get a pointer to the sparsity pattern of the argument that can be freed
-              int nnz = nodes[ch_ind]->sparsity().nnz();
+              int nnz = nodes[freed]->sparsity().nnz();
 
               // Add to the stack of unused work vector elements for the current sparsity
-              unused_all[nnz].push(place[ch_ind]);
+              unused_all[nnz].push(place[freed]);
             }
 
             // Point to the place in the work vector instead of to the place in the list of nodes
@@ -248,6 +339,16 @@ namespace casadi {
         for (int c=0; c<it->res.size(); ++c) {
           if (it->res[c]>=0) {
 
+            // A view gets a new element without storage of its own
+            if (view_node[it->res[c]]>=0) {
+              view_base_.resize(worksize+1, -1);
+              view_offset_.resize(worksize+1, 0);
+              view_base_[worksize] = place[view_node[it->res[c]]];
+              view_offset_[worksize] = view_nz[it->res[c]];
+              it->res[c] = place[it->res[c]] = worksize++;
+              continue;
+            }
+
             // Are reuse of variables (live variables) enabled?
             if (live_variables) {
               // Get a pointer to the sparsity pattern node
@@ -282,6 +383,8 @@ namespace casadi {
     }
 
     // Allocate work vectors (numeric)
+    view_base_.resize(worksize, -1);
+    view_offset_.resize(worksize, 0);
     workloc_.resize(worksize+1);
     fill(workloc_.begin(), workloc_.end(), -1);
     size_t wind=0, sz_w=0;
@@ -295,7 +398,7 @@ namespace casadi {
             sz_w = max(sz_w, it->data->sz_w());
             if (workloc_[it->res[c]] < 0) {
               workloc_[it->res[c]] = wind;
-              wind += it->data->sparsity(c).nnz();
+              if (view_base_[it->res[c]]<0) wind += it->data->sparsity(c).nnz();
             }
           }
         }
@@ -366,14 +469,191 @@ namespace casadi {
       }
     }
 
+    // Lower the algorithm for numerical evaluation
+    compile_plan();
+
     log("MXFunction::init end");
   }
 
+  Dict MXFunction::derived_options() const {
+    Dict opts = XFunction<MXFunction, MX, MXNode>::derived_options();
+    // Derivatives share the factorizations in the same way
+    if (merge_solves_) opts["merge_solves"] = true;
+    return opts;
+  }
+
+  void MXFunction::compile_plan() {
+    // Number of slots in the work vector
+    int nslot = workloc_.size()-1;
+
+    // Count the number of instructions writing to each slot
+    vector<int> nwrite(nslot, 0);
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_OUTPUT || is_view(e)) continue;
+      // An in-place reshape does not touch the data
+      if (e.op==OP_RESHAPE && e.res[0]==e.arg[0]) continue;
+      for (auto&& r : e.res) if (r>=0 && view_base_[r]<0) nwrite[r]++;
+    }
+
+    // Slots sharing storage with another slot
+    plan_view_.clear();
+    for (int k=0; k<nslot; ++k) {
+      if (view_base_[k]>=0) {
+        MXPlanAlias a = {k, view_base_[k], view_offset_[k]};
+        plan_view_.push_back(a);
+      }
+    }
+
+    // A slot that is only written by an input instruction can refer to the input directly
+    vector<bool> aliased(nslot, false);
+    alias_in_.clear();
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_INPUT && nwrite[e.res[0]]==1 && !aliased[e.res[0]]) {
+        aliased[e.res[0]] = true;
+        MXPlanAlias a = {e.res[0], e.arg[0], e.arg[2]};
+        alias_in_.push_back(a);
+      }
+    }
+
+    // A slot that is written once and then passed to an output can refer to the output directly
+    alias_out_.clear();
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_OUTPUT && nwrite[e.arg[0]]==1 && !aliased[e.arg[0]]) {
+        aliased[e.arg[0]] = true;
+        MXPlanAlias a = {e.arg[0], e.res[0], 0};
+        alias_out_.push_back(a);
+      }
+    }
+
+    // Lower the instructions
+    plan_.clear();
+    plan_slot_.clear();
+    plan_nz_.clear();
+    size_t sz_res_eval = 0;
+    for (auto&& e : algorithm_) {
+      MXPlanEl p;
+      p.node = 0;
+      p.ind = -1;
+      p.n = 0;
+      p.offset = 0;
+      p.slot = plan_slot_.size();
+      p.narg = p.nres = 0;
+      switch (e.op) {
+      case OP_INPUT:
+        p.op = PLAN_INPUT;
+        p.ind = e.arg[0];
+        p.n = e.data.nnz();
+        p.offset = e.arg[2];
+        p.nres = 1;
+        plan_slot_.push_back(e.res[0]);
+        break;
+      case OP_OUTPUT:
+        p.op = PLAN_OUTPUT;
+        p.ind = e.res[0];
+        p.n = nnz_out(p.ind);
+        p.narg = 1;
+        plan_slot_.push_back(e.arg[0]);
+        break;
+      default:
+        if (is_view(e)) continue;
+        if (e.op==OP_RESHAPE) {
+          // Nothing to do if in-place
+          if (e.res[0]==e.arg[0]) continue;
+          p.op = PLAN_COPY;
+          p.n = e.data.nnz();
+        } else if (e.op==OP_GETNONZEROS) {
+          vector<int> nz = static_cast<const GetNonzeros*>(e.data.get())->all();
+          p.op = PLAN_GATHER;
+          p.n = nz.size();
+          p.offset = plan_nz_.size();
+          plan_nz_.insert(plan_nz_.end(), nz.begin(), nz.end());
+        } else {
+          p.op = PLAN_EVAL;
+          p.node = static_cast<MXNode*>(e.data.get());
+          sz_res_eval = max(sz_res_eval, p.node->sz_res());
+        }
+        p.narg = e.arg.size();
+        p.nres = e.res.size();
+        plan_slot_.insert(plan_slot_.end(), e.arg.begin(), e.arg.end());
+        for (auto&& r : e.res) plan_slot_.push_back(r>=0 && view_base_[r]<0 ? r : -1);
+      }
+      plan_.push_back(p);
+    }
+
+    // Pointers to the slots, followed by the results of the evaluated nodes
+    alloc_res(nslot + sz_res_eval);
+
+    // Sort the instructions by dependency level for parallel evaluation
+    level_begin_.clear();
+    level_call_.clear();
+    n_lanes_ = 0;
+    lane_arg_ = lane_res_ = lane_iw_ = lane_w_ = 0;
+    if (!parallel_) return;
+
+    // Level of each instruction, each slot being written exactly once
+    vector<int> slot_level(nslot, 0), level(plan_.size());
+    int nlevel = 0;
+    for (int k=0; k<plan_.size(); ++k) {
+      const MXPlanEl& p = plan_[k];
+      const int* s = get_ptr(plan_slot_) + p.slot;
+      int l = 0;
+      for (int i=0; i<p.narg; ++i) {
+        if (s[i]>=0) l = max(l, slot_level[view_base_[s[i]]<0 ? s[i] : view_base_[s[i]]]);
+      }
+      for (int i=p.narg; i<p.narg+p.nres; ++i) if (s[i]>=0) slot_level[s[i]] = l+1;
+      level[k] = l;
+      nlevel = max(nlevel, l+1);
+    }
+
+    // Within each level, function calls come last
+    vector<vector<MXPlanEl> > serial(nlevel), calls(nlevel);
+    for (int k=0; k<plan_.size(); ++k) {
+      const MXPlanEl& p = plan_[k];
+      if (p.op==PLAN_EVAL && p.node->op()==OP_CALL) {
+        calls[level[k]].push_back(p);
+      } else {
+        serial[level[k]].push_back(p);
+      }
+    }
+    plan_.clear();
+    for (int l=0; l<nlevel; ++l) {
+      level_begin_.push_back(plan_.size());
+      plan_.insert(plan_.end(), serial[l].begin(), serial[l].end());
+      level_call_.push_back(plan_.size());
+      plan_.insert(plan_.end(), calls[l].begin(), calls[l].end());
+
+      // Work vectors needed for concurrent calls
+      if (calls[l].size()>1) {
+        n_lanes_ = max(n_lanes_, static_cast<int>(calls[l].size()));
+        for (auto&& p : calls[l]) {
+          lane_arg_ = max(lane_arg_, p.node->sz_arg());
+          lane_res_ = max(lane_res_, p.node->sz_res());
+          lane_iw_ = max(lane_iw_, p.node->sz_iw());
+          lane_w_ = max(lane_w_, p.node->sz_w());
+        }
+      }
+    }
+    level_begin_.push_back(plan_.size());
+    if (verbose()) {
+      userOut() << "Execution plan has " << nlevel << " levels, up to "
+                << n_lanes_ << " concurrent function calls" << endl;
+    }
+
+    // Separate work vectors for each concurrent call, followed by the memory objects
+    alloc_arg(n_lanes_*lane_arg_);
+    alloc_res(nslot + n_lanes_*lane_res_);
+    alloc_iw(n_lanes_*lane_iw_);
+    alloc_w(workloc_.back() + n_lanes_*lane_w_);
+  }
+
   void MXFunction::eval(void* mem, const double** arg, double** res, int* iw, double* w) const {
     casadi_msg("MXFunction::eval():begin "  << name_);
-    // Work vector and temporaries to hold pointers to operation input and outputs
+    // Pointers to the work vector slots and temporaries to hold pointers to operation
+    // input and outputs
+    int nslot = workloc_.size()-1;
+    double** slot = res+n_out();
     const double** arg1 = arg+n_in();
-    double** res1 = res+n_out();
+    double** res1 = slot+nslot;
 
     // Make sure that there are no free variables
     if (!free_vars_.empty()) {
@@ -383,40 +663,96 @@ namespace casadi {
                    << free_vars_ << " are free.");
     }
 
-    // Evaluate all of the nodes of the algorithm:
-    // should only evaluate nodes that have not yet been calculated!
-    for (auto&& e : algorithm_) {
-      if (e.op==OP_INPUT) {
-        // Pass an input
-        double *w1 = w+workloc_[e.res.front()];
-        int nnz=e.data.nnz();
-        int i=e.arg.at(0);
-        int nz_offset=e.arg.at(2);
-        if (arg[i]==0) {
-          fill(w1, w1+nnz, 0);
-        } else {
-          copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
-        }
-      } else if (e.op==OP_OUTPUT) {
-        // Get an output
-        double *w1 = w+workloc_[e.arg.front()];
-        int i=e.res.front();
-        if (res[i]!=0) copy(w1, w1+nnz_out(i), res[i]);
-      } else {
-        // Point pointers to the data corresponding to the element
-        for (int i=0; i<e.arg.size(); ++i)
-          arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : 0;
-        for (int i=0; i<e.res.size(); ++i)
-          res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : 0;
+    // Resolve the work vector slots, some of which refer to the inputs and outputs directly
+    for (int k=0; k<nslot; ++k) slot[k] = w + workloc_[k];
+    for (auto&& a : alias_in_) {
+      if (arg[a.ind]!=0) slot[a.slot] = const_cast<double*>(arg[a.ind]) + a.offset;
+    }
+    for (auto&& a : alias_out_) {
+      if (res[a.ind]!=0) slot[a.slot] = res[a.ind];
+    }
+    for (auto&& a : plan_view_) slot[a.slot] = slot[a.ind] + a.offset;
 
-        // Evaluate
-        e.data->eval(arg1, res1, iw, w, 0);
+    if (!parallel_) {
+      // Execute the plan
+      for (auto&& p : plan_) eval_instruction(p, arg, res, slot, arg1, res1, iw, w, 0);
+    } else {
+      // Execute the plan one dependency level at a time
+      for (int l=0; l+1<level_begin_.size(); ++l) {
+        const MXPlanEl* p_begin = get_ptr(plan_) + level_begin_[l];
+        const MXPlanEl* p_call = get_ptr(plan_) + level_call_[l];
+        const MXPlanEl* p_end = get_ptr(plan_) + level_begin_[l+1];
+        for (const MXPlanEl* p=p_begin; p!=p_end; ++p) {
+          // Function calls in the level are independent of each other
+          if (p==p_call && p_end-p_call>1) break;
+          eval_instruction(*p, arg, res, slot, arg1, res1, iw, w, 0);
+        }
+        int ncall = p_end-p_call;
+        if (ncall<=1) continue;
+
+        // Evaluate in parallel, each call checks out a memory object of its own
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif // WITH_OPENMP
+        for (int i=0; i<ncall; ++i) {
+          eval_instruction(p_call[i], arg, res, slot, arg1 + i*lane_arg_, res1 + i*lane_res_,
+                           iw + i*lane_iw_, w + workloc_.back() + i*lane_w_, 0);
+        }
       }
     }
 
     casadi_msg("MXFunction::eval():end "  << name_);
   }
 
+  void MXFunction::eval_instruction(const MXPlanEl& p, const double** arg, double** res,
+                                    double** slot, const double** arg1, double** res1,
+                                    int* iw, double* w, int mem) const {
+    const int* s = get_ptr(plan_slot_) + p.slot;
+    switch (p.op) {
+    case PLAN_INPUT:
+      {
+        // Pass an input, unless referred to directly
+        const double* a = arg[p.ind];
+        double* r = slot[s[0]];
+        if (a==0) {
+          fill_n(r, p.n, 0);
+        } else if (r!=a+p.offset) {
+          copy_n(a+p.offset, p.n, r);
+        }
+      }
+      break;
+    case PLAN_OUTPUT:
+      // Get an output, unless referred to directly
+      if (res[p.ind]!=0 && res[p.ind]!=slot[s[0]]) copy_n(slot[s[0]], p.n, res[p.ind]);
+      break;
+    case PLAN_COPY:
+      copy_n(slot[s[0]], p.n, slot[s[1]]);
+      break;
+    case PLAN_GATHER:
+      {
+        const double* a = slot[s[0]];
+        double* r = slot[s[1]];
+        const int* nz = get_ptr(plan_nz_) + p.offset;
+        for (int k=0; k<p.n; ++k) r[k] = nz[k]>=0 ? a[nz[k]] : 0;
+      }
+      break;
+    default:
+      // Point pointers to the data corresponding to the element
+      for (int i=0; i<p.narg; ++i) arg1[i] = s[i]>=0 ? slot[s[i]] : 0;
+      s += p.narg;
+      for (int i=0; i<p.nres; ++i) res1[i] = s[i]>=0 ? slot[s[i]] : 0;
+
+      // Evaluate
+      p.node->eval(arg1, res1, iw, w, mem);
+    }
+  }
+
+  bool MXFunction::is_view(const AlgEl& e) const {
+    if (e.op==OP_INPUT || e.op==OP_OUTPUT || e.op==OP_PARAMETER) return false;
+    for (auto&& r : e.res) if (r>=0 && view_base_[r]<0) return false;
+    return true;
+  }
+
   void MXFunction::print(ostream &stream, const AlgEl& el) const {
     if (el.op==OP_OUTPUT) {
       stream << "output[" << el.res.front() << "] = @" << el.arg.at(0);
@@ -492,14 +828,17 @@ namespace casadi {
         int i=it->res.front();
         int nnz=nnz_out(i);
         bvec_t* resi = res[i];
-        bvec_t* w1 = w + workloc_[it->arg.front()];
+        bvec_t* w1 = w + wloc(it->arg.front());
         if (resi!=0) copy(w1, w1+nnz, resi);
+      } else if (is_view(*it)) {
+        // Shares storage with its argument, nothing to do
+        continue;
       } else {
         // Point pointers to the data corresponding to the element
         for (int i=0; i<it->arg.size(); ++i)
-          arg1[i] = it->arg[i]>=0 ? w+workloc_[it->arg[i]] : 0;
+          arg1[i] = it->arg[i]>=0 ? w+wloc(it->arg[i]) : 0;
         for (int i=0; i<it->res.size(); ++i)
-          res1[i] = it->res[i]>=0 ? w+workloc_[it->res[i]] : 0;
+          res1[i] = it->res[i]>=0 && view_base_[it->res[i]]<0 ? w+workloc_[it->res[i]] : 0;
 
         // Propagate sparsity forwards
         it->data->sp_fwd(arg1, res1, iw, w, 0);
@@ -530,17 +869,20 @@ namespace casadi {
         int i=it->res.front();
         int nnz=nnz_out(i);
         bvec_t* resi = res[i];
-        bvec_t* w1 = w + workloc_[it->arg.front()];
+        bvec_t* w1 = w + wloc(it->arg.front());
         if (resi!=0) {
           for (int k=0; k<nnz; ++k) w1[k] |= resi[k];
           fill_n(resi, nnz, 0);
         }
+      } else if (is_view(*it)) {
+        // Shares storage with its argument, nothing to do
+        continue;
       } else {
         // Point pointers to the data corresponding to the element
         for (int i=0; i<it->arg.size(); ++i)
-          arg1[i] = it->arg[i]>=0 ? w+workloc_[it->arg[i]] : 0;
+          arg1[i] = it->arg[i]>=0 ? w+wloc(it->arg[i]) : 0;
         for (int i=0; i<it->res.size(); ++i)
-          res1[i] = it->res[i]>=0 ? w+workloc_[it->res[i]] : 0;
+          res1[i] = it->res[i]>=0 && view_base_[it->res[i]]<0 ? w+workloc_[it->res[i]] : 0;
 
         // Propagate sparsity backwards
         it->data->sp_rev(arg1, res1, iw, w, 0);
@@ -964,18 +1306,21 @@ namespace casadi {
         }
       } else if (it->op==OP_OUTPUT) {
         // Get the outputs
-        SXElem *w1 = w+workloc_[it->arg.front()];
+        SXElem *w1 = w+wloc(it->arg.front());
         int i=it->res.front();
         if (res[i]!=0)
           std::copy(w1, w1+nnz_out(i), res[i]);
       } else if (it->op==OP_PARAMETER) {
         continue; // FIXME
+      } else if (is_view(*it)) {
+        // Shares storage with its argument, nothing to do
+        continue;
       } else {
         // Point pointers to the data corresponding to the element
         for (int i=0; i<it->arg.size(); ++i)
-          argp[i] = it->arg[i]>=0 ? w+workloc_[it->arg[i]] : 0;
+          argp[i] = it->arg[i]>=0 ? w+wloc(it->arg[i]) : 0;
         for (int i=0; i<it->res.size(); ++i)
-          resp[i] = it->res[i]>=0 ? w+workloc_[it->res[i]] : 0;
+          resp[i] = it->res[i]>=0 && view_base_[it->res[i]]<0 ? w+workloc_[it->res[i]] : 0;
 
         // Evaluate
         it->data->eval_sx(get_ptr(argp), get_ptr(resp), iw, w, 0);
@@ -1078,7 +1423,7 @@ namespace casadi {
     bool first = true;
     for (int i=0; i<workloc_.size()-1; ++i) {
       int n=workloc_[i+1]-workloc_[i];
-      if (n==0) continue;
+      if (n==0 && view_base_[i]<0) continue;
       if (first) {
         s << "  real_t ";
         first = false;
@@ -1092,7 +1437,10 @@ namespace casadi {
          } else {
          ...
       */
-      if (!g.codegen_scalars && n==1) {
+      if (view_base_[i]>=0) {
+        // Shares storage with another element
+        s << "*w" << i << "=w" << view_base_[i] << "+" << view_offset_[i];
+      } else if (!g.codegen_scalars && n==1) {
         s << "w" << i;
       } else {
         s << "*w" << i << "=w+" << workloc_[i];
@@ -1149,6 +1497,9 @@ namespace casadi {
               << "    " << g.fill(g.work(i, n), n, "0") << endl;
           }
         }
+      } else if (is_view(*it)) {
+        // Shares storage with its argument, nothing to do
+        continue;
       } else {
         // Generate comment
         if (g.verbose) {
@@ -1161,7 +1512,7 @@ namespace casadi {
         arg.resize(it->arg.size());
         for (int i=0; i<it->arg.size(); ++i) {
           int j=it->arg.at(i);
-          if (j>=0 && workloc_.at(j)!=workloc_.at(j+1)) {
+          if (j>=0 && (view_base_.at(j)>=0 || workloc_.at(j)!=workloc_.at(j+1))) {
             arg.at(i) = j;
           } else {
             arg.at(i) = -1;
@@ -53,6 +53,43 @@ namespace casadi {
     /// Work vector indices of the results
     std::vector<int> res;
   };
+
+  /** \brief  An instruction of the compiled execution plan of an MXFunction */
+  struct MXPlanEl {
+    /// Instruction (see MXFunction::PlanOp)
+    int op;
+
+    /// Node to evaluate (PLAN_EVAL only)
+    MXNode* node;
+
+    /// Function input or output index (PLAN_INPUT and PLAN_OUTPUT only)
+    int ind;
+
+    /// Number of nonzeros moved
+    int n;
+
+    /// Nonzero offset into the input (PLAN_INPUT) or into the gather indices (PLAN_GATHER)
+    int offset;
+
+    /// Position of the work vector slots in MXFunction::plan_slot_, arguments first
+    int slot;
+
+    /// Number of argument and result slots
+    int narg, nres;
+  };
+
+  /** \brief  A work vector slot that refers directly to a function input or output,
+   *  or to part of another slot */
+  struct MXPlanAlias {
+    /// Work vector slot
+    int slot;
+
+    /// Function input or output index, or the slot referred to
+    int ind;
+
+    /// Nonzero offset into the input or slot referred to
+    int offset;
+  };
 #endif // SWIG
 
   /** \brief  Internal node class for MXFunction
@@ -71,6 +108,51 @@ namespace casadi {
     /** \brief Offsets for elements in the w_ vector */
     std::vector<int> workloc_;
 
+    /** \brief Element sharing storage with each element of the w_ vector (-1 if none)
+     * and the offset into its nonzeros */
+    std::vector<int> view_base_, view_offset_;
+
+    /** \brief Offset of the data of an element in the w_ vector */
+    int wloc(int ind) const {
+      return view_base_[ind]<0 ? workloc_[ind] : workloc_[view_base_[ind]] + view_offset_[ind];
+    }
+
+    /** \brief Is an element of the algorithm a view, i.e. nothing to evaluate */
+    bool is_view(const AlgEl& e) const;
+
+    /** \brief Instructions of the execution plan */
+    enum PlanOp {PLAN_INPUT, PLAN_OUTPUT, PLAN_EVAL, PLAN_COPY, PLAN_GATHER};
+
+    /** \brief Execution plan used for numerical evaluation, lowered from algorithm_ */
+    std::vector<MXPlanEl> plan_;
+
+    /** \brief Work vector slots of the plan instructions, -1 if null */
+    std::vector<int> plan_slot_;
+
+    /** \brief Nonzero indices of the inlined GetNonzeros nodes */
+    std::vector<int> plan_nz_;
+
+    /** \brief Work vector slots aliased with function inputs and outputs */
+    std::vector<MXPlanAlias> alias_in_, alias_out_;
+
+    /** \brief Work vector slots that are views into other slots */
+    std::vector<MXPlanAlias> plan_view_;
+
+    /** \brief Evaluate independent function calls in parallel */
+    bool parallel_;
+
+    /** \brief Linear solves with the same matrix have been merged */
+    bool merge_solves_;
+
+    /** \brief First instruction and first function call of each dependency level */
+    std::vector<int> level_begin_, level_call_;
+
+    /** \brief Number of function calls that can be evaluated concurrently */
+    int n_lanes_;
+
+    /** \brief Size of the work vectors of each concurrent function call */
+    size_t lane_arg_, lane_res_, lane_iw_, lane_w_;
+
     /// Free variables
     std::vector<MX> free_vars_;
 
@@ -105,6 +187,17 @@ namespace casadi {
     /** \brief  Initialize */
     virtual void init(const Dict& opts);
 
+    /** \brief Propagate options */
+    virtual Dict derived_options() const;
+
+    /** \brief  Lower the algorithm into an execution plan */
+    void compile_plan();
+
+    /** \brief  Execute an instruction of the execution plan */
+    void eval_instruction(const MXPlanEl& p, const double** arg, double** res, double** slot,
+                          const double** arg1, double** res1, int* iw, double* w,
+                          int mem) const;
+
     /** \brief Generate code for the declarations of the C function */
     virtual void generateDeclarations(CodeGenerator& g) const;
 
@@ -25,6 +25,8 @@
 
 #include "oracle_function.hpp"
 #include "external.hpp"
+#include "sx_reverse.hpp"
+#include "sx_hessian.hpp"
 
 #include <iostream>
 #include <iomanip>
@@ -35,6 +37,8 @@ namespace casadi {
 
   OracleFunction::OracleFunction(const std::string& name, const Function& oracle)
   : FunctionInternal(name), oracle_(oracle) {
+    numeric_gradient_ = false;
+    numeric_hessian_ = false;
   }
 
   OracleFunction::~OracleFunction() {
@@ -51,7 +55,16 @@ namespace casadi {
       {"specific_options",
        {OT_DICT,
         "Options for specific auto-generated functions,"
-        " overwriting the defaults from common_options. Nested dictionary."}}
+        " overwriting the defaults from common_options. Nested dictionary."}},
+      {"numeric_gradient",
+       {OT_BOOL,
+        "Calculate gradients (grad:f:x) of an SX oracle numerically with a taped reverse "
+        "sweep, rather than by creating a symbolic gradient expression"}},
+      {"numeric_hessian",
+       {OT_BOOL,
+        "Calculate Hessians (hess:f:x:x, also of linear combinations of outputs and with "
+        "the sym, triu and transpose attributes) of an SX oracle numerically by edge "
+        "pushing, rather than by creating a symbolic Hessian expression"}}
     }
   };
 
@@ -71,6 +84,10 @@ namespace casadi {
             " Type mismatch for entry '" + i.first+ "': "
             " got type " + i.second.get_description() + ".");
         }
+      } else if (op.first=="numeric_gradient") {
+        numeric_gradient_ = op.second;
+      } else if (op.first=="numeric_hessian") {
+        numeric_hessian_ = op.second;
       }
     }
   }
@@ -122,11 +139,150 @@ namespace casadi {
     Dict opt = combine(specific_options, common_options_);
 
     // Generate the function
-    Function ret = oracle_.factory(fname, s_in, s_out, aux, opt);
+    Function ret;
+    if (numeric_gradient_ && aux.empty()) ret = numeric_gradient(fname, s_in, s_out, opt);
+    if (numeric_hessian_ && ret.is_null()) ret = numeric_hessian(fname, s_in, s_out, aux, opt);
+    if (ret.is_null()) ret = oracle_.factory(fname, s_in, s_out, aux, opt);
     set_function(ret, fname, true);
     return ret;
   }
 
+  Function OracleFunction::numeric_gradient(const std::string& fname,
+                                            const std::vector<std::string>& s_in,
+                                            const std::vector<std::string>& s_out,
+                                            const Dict& opts) {
+    // Only for SX oracles
+    if (!oracle_.is_a("sxfunction")) return Function();
+    vector<string> o_in = oracle_.name_in(), o_out = oracle_.name_out();
+    int n_in = o_in.size(), n_out = o_out.size();
+
+    // Inputs, all inputs of the oracle are needed
+    vector<MX> ret_in, arg(n_in);
+    vector<bool> given(n_in, false);
+    for (auto&& s : s_in) {
+      auto it = find(o_in.begin(), o_in.end(), s);
+      if (it==o_in.end()) return Function();
+      int i = it - o_in.begin();
+      arg[i] = MX::sym(s, oracle_.sparsity_in(i));
+      given[i] = true;
+      ret_in.push_back(arg[i]);
+    }
+    if (find(given.begin(), given.end(), false)!=given.end()) return Function();
+
+    // Numeric adjoint function, one direction
+    Function rev;
+
+    // Outputs
+    vector<MX> ret_out, res;
+    for (auto&& s : s_out) {
+      // Nondifferentiated output
+      auto it = find(o_out.begin(), o_out.end(), s);
+      if (it!=o_out.end()) {
+        if (res.empty()) res = oracle_(arg);
+        ret_out.push_back(res.at(it - o_out.begin()));
+        continue;
+      }
+
+      // Otherwise, it must be the gradient of a scalar output
+      if (s.compare(0, 5, "grad:")!=0) return Function();
+      size_t sep = s.find(':', 5);
+      if (sep==string::npos) return Function();
+      auto f_it = find(o_out.begin(), o_out.end(), s.substr(5, sep-5));
+      auto x_it = find(o_in.begin(), o_in.end(), s.substr(sep+1));
+      if (f_it==o_out.end() || x_it==o_in.end()) return Function();
+      int f_ind = f_it - o_out.begin(), x_ind = x_it - o_in.begin();
+      if (!oracle_.sparsity_out(f_ind).is_scalar()) return Function();
+
+      // Create the adjoint function
+      if (rev.is_null()) {
+        vector<string> i_names, o_names;
+        for (int i=0; i<n_in; ++i) i_names.push_back("der_" + o_in[i]);
+        for (int i=0; i<n_out; ++i) i_names.push_back("der_" + o_out[i]);
+        for (int i=0; i<n_out; ++i) i_names.push_back("adj_" + o_out[i]);
+        for (int i=0; i<n_in; ++i) o_names.push_back("adj_" + o_in[i]);
+        rev = SXReverse::create("adj1_" + oracle_.name(), oracle_, 1,
+                                i_names, o_names, Dict());
+      }
+
+      // Unit seed for the output
+      vector<MX> rev_arg = arg;
+      for (int i=0; i<n_out; ++i) rev_arg.push_back(MX(oracle_.size_out(i)));
+      for (int i=0; i<n_out; ++i) {
+        rev_arg.push_back(i==f_ind ? MX(1.) : MX(oracle_.size_out(i)));
+      }
+      ret_out.push_back(rev(rev_arg).at(x_ind));
+    }
+
+    // Not needed if no gradients were requested
+    if (rev.is_null()) return Function();
+    return Function(fname, ret_in, ret_out, s_in, s_out, opts);
+  }
+
+  Function OracleFunction::numeric_hessian(const std::string& fname,
+                                           const std::vector<std::string>& s_in,
+                                           const std::vector<std::string>& s_out,
+                                           const Function::AuxOut& aux,
+                                           const Dict& opts) {
+    // Only for SX oracles
+    if (!oracle_.is_a("sxfunction")) return Function();
+
+    // All outputs must be Hessian blocks with respect to an input,
+    // possibly with attributes (e.g. "sym:hess:gamma:x:x")
+    vector<HBlock> blocks;
+    vector<vector<string> > attr;
+    for (auto&& s : s_out) {
+      size_t pos = 0;
+      attr.push_back(vector<string>());
+      while (s.compare(pos, 5, "hess:")!=0) {
+        size_t sep = s.find(':', pos);
+        if (sep==string::npos) return Function();
+        string a = s.substr(pos, sep-pos);
+        if (a!="sym" && a!="triu" && a!="transpose") return Function();
+        attr.back().push_back(a);
+        pos = sep+1;
+      }
+      blocks.push_back(HBlock(s.substr(pos+5)));
+      if (blocks.back().arg1!=blocks.back().arg2) return Function();
+      if (find(s_in.begin(), s_in.end(), blocks.back().arg1)==s_in.end()) return Function();
+    }
+
+    // Symbolic inputs, with the sparsity of the corresponding factory inputs
+    vector<MX> ret_in;
+    vector<MX> ret_out;
+    for (int k=0; k<blocks.size(); ++k) {
+      const HBlock& b = blocks[k];
+      // Scalar function to be differentiated, created with the factory,
+      // e.g. the linear combination "gamma" from the auxiliary outputs
+      Function ex_fcn = oracle_.factory(fname + "_" + b.ex, s_in, {b.ex}, aux);
+      if (!ex_fcn.sparsity_out(0).is_scalar()) return Function();
+      if (ret_in.empty()) {
+        for (int i=0; i<s_in.size(); ++i) ret_in.push_back(MX::sym(s_in[i],
+                                                                   ex_fcn.sparsity_in(i)));
+      }
+
+      // Lower triangular part of the Hessian, transposed
+      int x_ind = find(s_in.begin(), s_in.end(), b.arg1) - s_in.begin();
+      Function h = SXHessian::create(fname + "_" + b.ex + "_tril", ex_fcn, x_ind, 0, Dict());
+      MX r = h(ret_in).at(0).T();
+
+      // Process attributes, innermost first
+      for (auto a=attr[k].rbegin(); a!=attr[k].rend(); ++a) {
+        if (*a=="sym") {
+          r = triu2symm(r);
+        } else if (*a=="triu") {
+          r = triu(r);
+        } else if (*a=="transpose") {
+          r = r.T();
+        }
+      }
+      ret_out.push_back(r);
+    }
+
+    // Not needed if no Hessians were requested
+    if (ret_out.empty()) return Function();
+    return Function(fname, ret_in, ret_out, s_in, s_out, opts);
+  }
+
   void OracleFunction::
   set_function(const Function& fcn, const std::string& fname, bool jit) {
     casadi_assert_message(!has_function(fname), "Duplicate function " + fname);
@@ -184,9 +340,10 @@ namespace casadi {
       }
     }
 
-    // Evaluate memory-less
+    // Evaluate with a memory object of its own
     try {
-      f(m->arg, m->res, m->iw, m->w, 0);
+      ScopedCheckout mem(f);
+      f(m->arg, m->res, m->iw, m->w, mem);
     } catch(exception& ex) {
       // Fatal error
       userOut<true, PL_WARN>()
@@ -57,6 +57,12 @@ namespace casadi {
     Dict common_options_;
     Dict specific_options_;
 
+    /// Calculate gradients of an SX oracle numerically, with a taped reverse sweep
+    bool numeric_gradient_;
+
+    /// Calculate Hessians of an SX oracle numerically, by edge pushing
+    bool numeric_hessian_;
+
     // Information about one function
     struct RegFun {
       Function f;
@@ -98,6 +104,21 @@ namespace casadi {
                     const std::vector<std::string>& s_out,
                     const Function::AuxOut& aux=Function::AuxOut());
 
+    /** Create an oracle function with numeric gradients, null if not applicable */
+    Function
+    numeric_gradient(const std::string& fname,
+                     const std::vector<std::string>& s_in,
+                     const std::vector<std::string>& s_out,
+                     const Dict& opts);
+
+    /** Create an oracle function with numeric Hessians, null if not applicable */
+    Function
+    numeric_hessian(const std::string& fname,
+                    const std::vector<std::string>& s_in,
+                    const std::vector<std::string>& s_out,
+                    const Function::AuxOut& aux,
+                    const Dict& opts);
+
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn, const std::string& fname, bool jit=false);
 
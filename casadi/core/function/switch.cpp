@@ -165,7 +165,8 @@ namespace casadi {
     }
 
     // Evaluate the corresponding function
-    fk(arg1, res1, iw, w, 0);
+    ScopedCheckout fk_mem(fk);
+    fk(arg1, res1, iw, w, fk_mem);
 
     // Project results with different sparsity
     for (int i=0; i<n_out; ++i) {
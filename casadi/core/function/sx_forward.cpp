@@ -0,0 +1,87 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_forward.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Function SXForward::create(const std::string& name, const Function& f, int nfwd,
+                             const std::vector<std::string>& i_names,
+                             const std::vector<std::string>& o_names,
+                             const Dict& opts) {
+    return instantiate(new SXForward(name, f, nfwd), i_names, o_names, opts);
+  }
+
+  SXForward::SXForward(const std::string& name, const Function& f, int nfwd)
+    : SXNumeric(name, f), nfwd_(nfwd) {
+  }
+
+  SXForward::~SXForward() {
+  }
+
+  Sparsity SXForward::get_sparsity_in(int i) {
+    int n_in = f_.n_in(), n_out = f_.n_out();
+    if (i<n_in) {
+      return f_.sparsity_in(i);
+    } else if (i<n_in+n_out) {
+      return Sparsity(f_.size_out(i-n_in));
+    } else {
+      return repmat(f_.sparsity_in(i-n_in-n_out), 1, nfwd_);
+    }
+  }
+
+  Sparsity SXForward::get_sparsity_out(int i) {
+    return repmat(f_.sparsity_out(i), 1, nfwd_);
+  }
+
+  void SXForward::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    SXNumeric::init(opts);
+
+    // Values followed by the tangents
+    alloc_w(f_.sz_w()*(1+nfwd_));
+
+    if (verbose()) {
+      log("SXForward::init", "Propagating " + to_string(nfwd_) + " tangents through "
+          + f_.name() + " numerically");
+    }
+  }
+
+  void SXForward::eval(void* mem, const double** arg, double** res, int* iw, double* w) const {
+    int n_in = f_.n_in(), n_out = f_.n_out();
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    f->eval_fwd(arg, 0, arg + n_in + n_out, res, nfwd_, w);
+  }
+
+  Function SXForward::get_symbolic() {
+    SXFunction* f = static_cast<SXFunction*>(f_.get());
+    return f->XFunction<SXFunction, SX, SXNode>::get_forward(name_, nfwd_, ischeme_, oscheme_,
+                                                             f->derived_options());
+  }
+
+} // namespace casadi
@@ -0,0 +1,88 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SX_FORWARD_HPP
+#define CASADI_SX_FORWARD_HPP
+
+#include "sx_numeric.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Forward derivatives of an SXFunction, calculated numerically
+
+      Has the inputs and outputs of a forward derivative function, but is evaluated
+      by propagating tangents through the algorithm of the SXFunction, see
+      SXFunction::eval_fwd. No symbolic expressions are created unless derivatives
+      of this function are requested.
+  */
+  class CASADI_EXPORT SXForward : public SXNumeric {
+  public:
+    // Create function (use instead of constructor)
+    static Function create(const std::string& name, const Function& f, int nfwd,
+                           const std::vector<std::string>& i_names,
+                           const std::vector<std::string>& o_names,
+                           const Dict& opts);
+
+    /** \brief Destructor */
+    virtual ~SXForward();
+
+    /** \brief Get type name */
+    virtual std::string type_name() const { return "sxforward";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    virtual size_t get_n_in() { return 2*f_.n_in() + f_.n_out();}
+    virtual size_t get_n_out() { return f_.n_out();}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    virtual Sparsity get_sparsity_in(int i);
+    virtual Sparsity get_sparsity_out(int i);
+    /// @}
+
+    /** \brief  Initialize */
+    virtual void init(const Dict& opts);
+
+    /** \brief  Evaluate numerically, work vectors given */
+    virtual void eval(void* mem, const double** arg, double** res, int* iw, double* w) const;
+
+  protected:
+    // Constructor (protected, use create function)
+    SXForward(const std::string& name, const Function& f, int nfwd);
+
+    // Create the equivalent symbolic function
+    virtual Function get_symbolic();
+
+    // Number of forward directions
+    int nfwd_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_FORWARD_HPP
@@ -24,6 +24,8 @@
 
 
 #include "sx_function.hpp"
+#include "sx_forward.hpp"
+#include "sx_reverse.hpp"
 #include <limits>
 #include <stack>
 #include <deque>
@@ -60,6 +62,10 @@ namespace casadi {
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    numeric_forward_ = false;
+    numeric_reverse_ = false;
+    hessian_edge_pushing_ = false;
+    sp_words_ = 4;
   }
 
   SXFunction::~SXFunction() {
@@ -81,6 +87,13 @@ namespace casadi {
                    << free_vars_ << " are free.");
     }
 
+    // Evaluate using the pre-decoded bytecode, if available
+    if (!bytecode_.empty()) {
+      eval_bytecode(arg, res, w);
+      casadi_msg("SXFunction::eval():end " << name_);
+      return;
+    }
+
     // NOTE: The implementation of this function is very delicate. Small changes in the
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
@@ -102,8 +115,731 @@ namespace casadi {
   }
 
 
+  void SXFunction::eval_fwd(const double** arg, double** res,
+                            const double** fseed, double** fsens, int nfwd, double* w) const {
+    // Make sure no free parameters
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables "
+                   << free_vars_ << " are free.");
+    }
+
+    // Tangents, stored after the values, one block of nfwd directions per element
+    double* t = w + sz_w();
+
+    // Partial derivatives
+    double d[2];
+
+    // Evaluate the algorithm, propagating the tangents
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_CONST:
+        w[e.i0] = e.d;
+        fill_n(t + e.i0*nfwd, nfwd, 0.);
+        break;
+      case OP_INPUT:
+        {
+          w[e.i0] = arg[e.i1]==0 ? 0 : arg[e.i1][e.i2];
+          const double* s = fseed[e.i1];
+          int nnz = nnz_in(e.i1);
+          double* t0 = t + e.i0*nfwd;
+          for (int k=0; k<nfwd; ++k) t0[k] = s==0 ? 0 : s[k*nnz + e.i2];
+        }
+        break;
+      case OP_OUTPUT:
+        {
+          const double* t1 = t + e.i1*nfwd;
+          if (res!=0 && res[e.i0]!=0) res[e.i0][e.i2] = w[e.i1];
+          double* s = fsens[e.i0];
+          int nnz = nnz_out(e.i0);
+          if (s!=0) for (int k=0; k<nfwd; ++k) s[k*nnz + e.i2] = t1[k];
+        }
+        break;
+      default:
+        {
+          // Value and partial derivatives
+          switch (e.op) {
+            CASADI_MATH_DERF_BUILTIN(w[e.i1], w[e.i2], w[e.i0], d)
+          default:
+            casadi_error("SXFunction::eval_fwd: Unknown operation" << e.op);
+          }
+
+          // Chain rule
+          double* t0 = t + e.i0*nfwd;
+          const double* t1 = t + e.i1*nfwd;
+          const double* t2 = t + e.i2*nfwd;
+          if (casadi_math<double>::ndeps(e.op)==2) {
+            for (int k=0; k<nfwd; ++k) t0[k] = d[0]*t1[k] + d[1]*t2[k];
+          } else {
+            for (int k=0; k<nfwd; ++k) t0[k] = d[0]*t1[k];
+          }
+        }
+      }
+    }
+  }
+
+  Function SXFunction::get_forward(const std::string& name, int nfwd,
+                                   const std::vector<std::string>& i_names,
+                                   const std::vector<std::string>& o_names,
+                                   const Dict& opts) {
+    if (numeric_forward_) {
+      return SXForward::create(name, self(), nfwd, i_names, o_names, opts);
+    }
+    return XFunction<SXFunction, SX, SXNode>::get_forward(name, nfwd, i_names, o_names, opts);
+  }
+
+  void SXFunction::eval_adj(const double** arg, double** res,
+                            const double** aseed, double** asens, int nadj, double* w) const {
+    // Make sure no free parameters
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables "
+                   << free_vars_ << " are free.");
+    }
+
+    // Tape with the partial derivatives, followed by the adjoints
+    double* tape = w + sz_w();
+    double* a = tape + 2*operations_.size();
+
+    // Forward sweep: evaluate and record the partial derivatives
+    double* d = tape;
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_CONST: w[e.i0] = e.d; break;
+      case OP_INPUT: w[e.i0] = arg[e.i1]==0 ? 0 : arg[e.i1][e.i2]; break;
+      case OP_OUTPUT: if (res!=0 && res[e.i0]!=0) res[e.i0][e.i2] = w[e.i1]; break;
+      default:
+        switch (e.op) {
+          CASADI_MATH_DERF_BUILTIN(w[e.i1], w[e.i2], w[e.i0], d)
+        default:
+          casadi_error("SXFunction::eval_adj: Unknown operation" << e.op);
+        }
+        d += 2;
+      }
+    }
+
+    // Clear adjoints and sensitivities
+    fill_n(a, sz_w()*nadj, 0.);
+    for (int i=0; i<n_in(); ++i) {
+      if (asens[i]!=0) fill_n(asens[i], nadj*nnz_in(i), 0.);
+    }
+
+    // Reverse sweep
+    for (auto e=algorithm_.rbegin(); e!=algorithm_.rend(); ++e) {
+      double* a0 = a + e->i0*nadj;
+      switch (e->op) {
+      case OP_CONST:
+        fill_n(a0, nadj, 0.);
+        break;
+      case OP_INPUT:
+        {
+          double* s = asens[e->i1];
+          int nnz = nnz_in(e->i1);
+          if (s!=0) for (int k=0; k<nadj; ++k) s[k*nnz + e->i2] += a0[k];
+          fill_n(a0, nadj, 0.);
+        }
+        break;
+      case OP_OUTPUT:
+        {
+          const double* s = aseed[e->i0];
+          int nnz = nnz_out(e->i0);
+          double* a1 = a + e->i1*nadj;
+          if (s!=0) for (int k=0; k<nadj; ++k) a1[k] += s[k*nnz + e->i2];
+        }
+        break;
+      default:
+        {
+          d -= 2;
+          double* a1 = a + e->i1*nadj;
+          double* a2 = a + e->i2*nadj;
+          bool binary = casadi_math<double>::ndeps(e->op)==2;
+          for (int k=0; k<nadj; ++k) {
+            double seed = a0[k];
+            a0[k] = 0;
+            a1[k] += d[0]*seed;
+            if (binary) a2[k] += d[1]*seed;
+          }
+        }
+      }
+    }
+  }
+
+  Function SXFunction::get_reverse(const std::string& name, int nadj,
+                                   const std::vector<std::string>& i_names,
+                                   const std::vector<std::string>& o_names,
+                                   const Dict& opts) {
+    if (numeric_reverse_) {
+      return SXReverse::create(name, self(), nadj, i_names, o_names, opts);
+    }
+    return XFunction<SXFunction, SX, SXNode>::get_reverse(name, nadj, i_names, o_names, opts);
+  }
+
+  const Function& SXFunction::op_hess(int op) const {
+    auto it = op_hess_.find(op);
+    if (it!=op_hess_.end()) return it->second;
+
+    // First order partial derivatives with respect to symbolic arguments
+    SXElem x = SXElem::sym("x"), y = SXElem::sym("y"), f, d[2];
+    casadi_math<SXElem>::derF(op, x, y, f, d);
+
+    // Differentiate once more, exploiting symmetry
+    SX xs = x, ys = y;
+    vector<SX> h = {SX::jacobian(d[0], xs), SX::jacobian(d[0], ys), SX::jacobian(d[1], ys)};
+    Function& ret = op_hess_[op];
+    ret = Function("op_hess", {xs, ys}, h);
+    return ret;
+  }
+
+  /// Value of a free variable in an edge pushing sweep (not available numerically)
+  static inline void ep_free(const SXElem& v, SXElem& r) { r = v;}
+  static inline void ep_free(const SXElem& v, double& r) { r = nan;}
+
+  /// Evaluate the second order partial derivatives of an operation
+  static inline void ep_op_hess(const Function& f, const double* xy, double* h, double* w) {
+    const double* arg[2] = {xy, xy+1};
+    double* res[3] = {h, h+1, h+2};
+    f->eval(0, arg, res, 0, w);
+  }
+  static inline void ep_op_hess(const Function& f, const SXElem* xy, SXElem* h, SXElem* w) {
+    const SXElem* arg[2] = {xy, xy+1};
+    SXElem* res[3] = {h, h+1, h+2};
+    f->eval_sx(arg, res, 0, w, 0);
+  }
+
+  /// Does an operation have nonzero second order partial derivatives?
+  static inline bool ep_nonlinear(int op) {
+    switch (op) {
+    case OP_ASSIGN: case OP_ADD: case OP_SUB: case OP_NEG: case OP_TWICE:
+      return false;
+    default:
+      return true;
+    }
+  }
+
+  /// Symmetric pair of edges in an edge pushing sweep, created if needed
+  static int ep_edge(vector<map<int, int> >& W, int i, int j, int& n_edge) {
+    auto it = W[i].insert(make_pair(j, n_edge));
+    if (!it.second) return it.first->second;
+    if (i!=j) W[j][i] = n_edge;
+    return n_edge++;
+  }
+
+  void SXFunction::ep_record(int iind, int oind, EPTape& tape) const {
+    casadi_assert_message(sparsity_out(oind).is_scalar(), "Function must be scalar");
+    int n_alg = algorithm_.size();
+    tape.instr.clear();
+    tape.kind.assign(n_alg, EPTape::EP_INACTIVE);
+    tape.seed = -1;
+    tape.n_edge = 0;
+    tape.sz_wh = 0;
+
+    // Variable (instruction) occupying each element of the work vector,
+    // -1 if it does not depend on the input
+    vector<int> var(sz_w(), -1);
+
+    // Per variable: active arguments, structurally nonzero second order partial derivatives
+    vector<int> na(n_alg, 0), dep(2*n_alg);
+    vector<char> h_nz(3*n_alg, 0);
+
+    // Forward sweep: determine the active arguments
+    for (int k=0; k<n_alg; ++k) {
+      const AlgEl& e = algorithm_[k];
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        var[e.i0] = -1;
+        break;
+      case OP_INPUT:
+        var[e.i0] = e.i1==iind ? k : -1;
+        break;
+      case OP_OUTPUT:
+        if (e.i0==oind) tape.seed = var[e.i1];
+        break;
+      default:
+        {
+          int v1 = var[e.i1];
+          int v2 = casadi_math<double>::ndeps(e.op)==2 ? var[e.i2] : -1;
+          if (v1<0 && v2<0) {
+            var[e.i0] = -1;
+            break;
+          }
+          var[e.i0] = k;
+
+          // Second order partial derivatives, if the operation is nonlinear
+          bool hk_nz[3] = {false, false, false};
+          if (ep_nonlinear(e.op)) {
+            const Function& fh = op_hess(e.op);
+            tape.sz_wh = max(tape.sz_wh, fh.sz_w());
+            for (int i=0; i<3; ++i) hk_nz[i] = fh.nnz_out(i)>0;
+          }
+
+          // Record the active arguments
+          int* depk = &dep[2*k];
+          char* hh_nz = &h_nz[3*k];
+          if (v1==v2) {
+            tape.kind[k] = EPTape::EP_SAME;
+            na[k] = 1;
+            depk[0] = v1;
+            hh_nz[0] = hk_nz[0] || hk_nz[1] || hk_nz[2];
+          } else if (v2<0) {
+            tape.kind[k] = EPTape::EP_FIRST;
+            na[k] = 1;
+            depk[0] = v1;
+            hh_nz[0] = hk_nz[0];
+          } else if (v1<0) {
+            tape.kind[k] = EPTape::EP_SECOND;
+            na[k] = 1;
+            depk[0] = v2;
+            hh_nz[0] = hk_nz[2];
+          } else {
+            tape.kind[k] = EPTape::EP_BOTH;
+            na[k] = 2;
+            depk[0] = v1;
+            depk[1] = v2;
+            copy_n(hk_nz, 3, hh_nz);
+          }
+        }
+      }
+    }
+
+    // Nonlinear interactions between the variables, stored symmetrically as edge indices
+    vector<map<int, int> > W(n_alg);
+
+    // Structurally nonzero adjoints
+    vector<char> a_nz(n_alg, 0);
+    if (tape.seed>=0) a_nz[tape.seed] = 1;
+
+    // Reverse sweep
+    for (int k=n_alg-1; k>=0; --k) {
+      int nk = na[k];
+      if (nk==0) continue;
+      const int* depk = &dep[2*k];
+      const char* hh_nz = &h_nz[3*k];
+
+      // Pushing: distribute the edges of the variable to its arguments
+      if (!W[k].empty()) {
+        int wkk = -1;
+        for (auto&& e : W[k]) {
+          int p = e.first;
+          if (p==k) {
+            wkk = e.second;
+            continue;
+          }
+          W[p].erase(k);
+          for (int i=0; i<nk; ++i) {
+            if (depk[i]==p) {
+              tape.instr.push_back({EPTape::EP_PUSH2, ep_edge(W, p, p, tape.n_edge),
+                                    e.second, 2*k+i, 0});
+            } else {
+              tape.instr.push_back({EPTape::EP_PUSH, ep_edge(W, depk[i], p, tape.n_edge),
+                                    e.second, 2*k+i, 0});
+            }
+          }
+        }
+        if (wkk>=0) {
+          for (int i=0; i<nk; ++i) {
+            for (int j=i; j<nk; ++j) {
+              tape.instr.push_back({EPTape::EP_PUSHSQ,
+                                    ep_edge(W, depk[i], depk[j], tape.n_edge),
+                                    wkk, 2*k+i, 2*k+j});
+            }
+          }
+        }
+        W[k].clear();
+      }
+
+      // Quick continue if no adjoint
+      if (!a_nz[k]) continue;
+
+      // Creating: new edges from the second order partial derivatives
+      if (hh_nz[0]) {
+        tape.instr.push_back({EPTape::EP_CREATE, ep_edge(W, depk[0], depk[0], tape.n_edge),
+                              k, 3*k, 0});
+      }
+      if (nk==2) {
+        if (hh_nz[1]) {
+          tape.instr.push_back({EPTape::EP_CREATE, ep_edge(W, depk[0], depk[1], tape.n_edge),
+                                k, 3*k+1, 0});
+        }
+        if (hh_nz[2]) {
+          tape.instr.push_back({EPTape::EP_CREATE, ep_edge(W, depk[1], depk[1], tape.n_edge),
+                                k, 3*k+2, 0});
+        }
+      }
+
+      // Adjoint: propagate the first order derivatives
+      for (int i=0; i<nk; ++i) {
+        tape.instr.push_back({EPTape::EP_ADJ, depk[i], k, 2*k+i, 0});
+        a_nz[depk[i]] = 1;
+      }
+    }
+
+    // Lower triangular part, in terms of the nonzeros of the input
+    tape.row.clear();
+    tape.col.clear();
+    tape.edge.clear();
+    for (int k=0; k<n_alg; ++k) {
+      const AlgEl& e = algorithm_[k];
+      if (e.op!=OP_INPUT || e.i1!=iind) continue;
+      for (auto&& w : W[k]) {
+        int r = algorithm_[w.first].i2;
+        if (r<e.i2) continue;
+        tape.row.push_back(r);
+        tape.col.push_back(e.i2);
+        tape.edge.push_back(w.second);
+      }
+    }
+
+    // Work vector: values, partial derivatives, adjoints, edges, operation Hessians
+    tape.sz_w = sz_w() + 6*n_alg + tape.n_edge + tape.sz_wh;
+  }
+
+  template<typename T>
+  const T* SXFunction::ep_eval(const EPTape& tape, const T** arg, T* w) const {
+    int n_alg = algorithm_.size();
+    T *v = w, *d = v + sz_w(), *h = d + 2*n_alg, *a = h + 3*n_alg, *s = a + n_alg;
+    T *wh = s + tape.n_edge;
+
+    // Forward sweep: evaluate and calculate the partial derivatives
+    vector<SXElem>::const_iterator p_it = free_vars_.begin();
+    for (int k=0; k<n_alg; ++k) {
+      const AlgEl& e = algorithm_[k];
+      switch (e.op) {
+      case OP_CONST:
+        v[e.i0] = e.d;
+        break;
+      case OP_PARAMETER:
+        ep_free(*p_it++, v[e.i0]);
+        break;
+      case OP_INPUT:
+        v[e.i0] = arg==0 || arg[e.i1]==0 ? 0 : arg[e.i1][e.i2];
+        break;
+      case OP_OUTPUT:
+        break;
+      default:
+        {
+          // Evaluate with partial derivatives, arguments copied since the result may alias
+          T xy[2] = {v[e.i1], v[e.i2]}, dk[2];
+          casadi_math<T>::derF(e.op, xy[0], xy[1], v[e.i0], dk);
+          if (tape.kind[k]==EPTape::EP_INACTIVE) break;
+
+          // Second order partial derivatives, if the operation is nonlinear
+          T hk[3] = {0, 0, 0};
+          if (ep_nonlinear(e.op)) ep_op_hess(op_hess(e.op), xy, hk, wh);
+
+          // Partial derivatives with respect to the active arguments
+          T* dd = d + 2*k;
+          T* hh = h + 3*k;
+          switch (tape.kind[k]) {
+          case EPTape::EP_SAME:
+            dd[0] = dk[0] + dk[1];
+            hh[0] = hk[0] + 2*hk[1] + hk[2];
+            break;
+          case EPTape::EP_FIRST:
+            dd[0] = dk[0];
+            hh[0] = hk[0];
+            break;
+          case EPTape::EP_SECOND:
+            dd[0] = dk[1];
+            hh[0] = hk[2];
+            break;
+          default:
+            copy_n(dk, 2, dd);
+            copy_n(hk, 3, hh);
+          }
+        }
+      }
+    }
+
+    // Reverse sweep: replay the instructions
+    fill_n(a, n_alg, 0);
+    fill_n(s, tape.n_edge, 0);
+    if (tape.seed>=0) a[tape.seed] = 1;
+    for (auto&& i : tape.instr) {
+      switch (i.op) {
+      case EPTape::EP_PUSH: s[i.dst] += d[i.i1]*s[i.src]; break;
+      case EPTape::EP_PUSH2: s[i.dst] += 2*d[i.i1]*s[i.src]; break;
+      case EPTape::EP_PUSHSQ: s[i.dst] += d[i.i1]*d[i.i2]*s[i.src]; break;
+      case EPTape::EP_CREATE: s[i.dst] += a[i.src]*h[i.i1]; break;
+      case EPTape::EP_ADJ: a[i.dst] += a[i.src]*d[i.i1]; break;
+      }
+    }
+    return s;
+  }
+
+  template<typename T>
+  void SXFunction::hess_edge_pushing(const T** arg, int iind, int oind, vector<int>& row,
+                                     vector<int>& col, vector<T>& val) const {
+    EPTape tape;
+    ep_record(iind, oind, tape);
+    vector<T> w(tape.sz_w);
+    const T* s = ep_eval(tape, arg, get_ptr(w));
+    row = tape.row;
+    col = tape.col;
+    val.resize(tape.edge.size());
+    for (int k=0; k<val.size(); ++k) val[k] = s[tape.edge[k]];
+  }
+
+  // Instantiate the numeric and symbolic versions
+  template const double* SXFunction::ep_eval<double>(
+    const EPTape& tape, const double** arg, double* w) const;
+  template const SXElem* SXFunction::ep_eval<SXElem>(
+    const EPTape& tape, const SXElem** arg, SXElem* w) const;
+  template void SXFunction::hess_edge_pushing<double>(
+    const double** arg, int iind, int oind, vector<int>& row, vector<int>& col,
+    vector<double>& val) const;
+  template void SXFunction::hess_edge_pushing<SXElem>(
+    const SXElem** arg, int iind, int oind, vector<int>& row, vector<int>& col,
+    vector<SXElem>& val) const;
+
+  SX SXFunction::hess_tril(int iind, int oind) {
+    // Edge pushing with the symbolic inputs
+    vector<const SXElem*> arg(n_in());
+    for (int i=0; i<n_in(); ++i) arg[i] = get_ptr(in_[i].nonzeros());
+    vector<int> row, col, mapping;
+    vector<SXElem> val;
+    hess_edge_pushing(get_ptr(arg), iind, oind, row, col, val);
+
+    // Nonzeros to elements
+    const Sparsity& sp = sparsity_in(iind);
+    vector<int> ind = sp.find();
+    for (int& r : row) r = ind[r];
+    for (int& c : col) c = ind[c];
+    Sparsity sp_h = Sparsity::triplet(sp.numel(), sp.numel(), row, col, mapping, false);
+    vector<SXElem> nz(mapping.size());
+    for (int k=0; k<nz.size(); ++k) nz[k] = val[mapping[k]];
+    return SX(sp_h, nz);
+  }
+
+  template<>
+  SX Factory<SX>::hessian_triu(const SX& ex, const SX& arg) const {
+    if (!hessian_edge_pushing_) return triu(SX::hessian(ex, arg));
+    Function f("tmp", {arg}, {ex});
+    return static_cast<SXFunction*>(f.get())->hess_tril().T();
+  }
+
+  /// Instructions of the SXFunction bytecode
+  enum BytecodeCode {
+    // Operations without a dedicated instruction, dispatched on the operator index
+    BC_GENERIC,
+    // End of the bytecode
+    BC_END,
+    // Single atomic operations
+    BC_CONST, BC_INPUT, BC_OUTPUT,
+    BC_ADD, BC_SUB, BC_MUL, BC_DIV, BC_NEG, BC_SQ,
+    // Superinstructions: multiply-add and constant multiplication
+    BC_MULADD, BC_CONSTMUL,
+    // Superinstructions: input followed by a binary operation
+    BC_INPUT_ADD, BC_INPUT_SUB, BC_INPUT_MUL, BC_INPUT_DIV,
+    // Superinstructions: binary operation followed by an output
+    BC_ADD_OUTPUT, BC_SUB_OUTPUT, BC_MUL_OUTPUT, BC_DIV_OUTPUT,
+    // Number of instructions
+    BC_NUM
+  };
+
+  /// Bytecode instruction for a single atomic operation
+  static int bytecode_code(int op) {
+    switch (op) {
+    case OP_CONST: return BC_CONST;
+    case OP_INPUT: return BC_INPUT;
+    case OP_OUTPUT: return BC_OUTPUT;
+    case OP_ADD: return BC_ADD;
+    case OP_SUB: return BC_SUB;
+    case OP_MUL: return BC_MUL;
+    case OP_DIV: return BC_DIV;
+    case OP_NEG: return BC_NEG;
+    case OP_SQ: return BC_SQ;
+    default: return BC_GENERIC;
+    }
+  }
+
+  /// Is the operation one of the four arithmetic operations
+  static bool is_arithmetic(int op) {
+    return op==OP_ADD || op==OP_SUB || op==OP_MUL || op==OP_DIV;
+  }
+
+  /// Does an atomic operation read the work vector element \a i
+  static bool reads(const ScalarAtomic& e, int i) {
+    return e.op==OP_OUTPUT ? e.i1==i : (e.i1==i || e.i2==i);
+  }
+
+  void SXFunction::init_bytecode() {
+    bytecode_.clear();
+    bytecode_.reserve(algorithm_.size()+1);
+
+    // Number of superinstructions
+    int n_fused = 0;
+
+    for (auto it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      BytecodeEl b;
+      b.code = bytecode_code(it->op);
+      b.op = it->op;
+      b.i0 = it->i0;
+      if (it->op==OP_CONST) {
+        b.d = it->d;
+        b.i1 = b.i2 = 0;
+      } else {
+        b.i1 = it->i1;
+        b.i2 = it->i2;
+        b.d = 0;
+      }
+      b.j0 = b.j1 = b.j2 = 0;
+
+      // Try to fuse with the next operation
+      auto next = it+1;
+      if (next!=algorithm_.end() && reads(*next, it->i0)) {
+        int code = BC_GENERIC;
+        if (it->op==OP_MUL && next->op==OP_ADD) {
+          code = BC_MULADD;
+        } else if (it->op==OP_CONST && next->op==OP_MUL) {
+          code = BC_CONSTMUL;
+        } else if (it->op==OP_INPUT && is_arithmetic(next->op)) {
+          code = BC_INPUT_ADD + next->op - OP_ADD;
+        } else if (is_arithmetic(it->op) && next->op==OP_OUTPUT) {
+          code = BC_ADD_OUTPUT + it->op - OP_ADD;
+        }
+        if (code!=BC_GENERIC) {
+          b.code = code;
+          b.j0 = next->i0;
+          b.j1 = next->i1;
+          b.j2 = next->i2;
+          n_fused++;
+          ++it;
+        }
+      }
+      bytecode_.push_back(b);
+    }
+
+    // Terminate
+    BytecodeEl b;
+    b.code = BC_END;
+    b.op = 0;
+    b.i0 = b.i1 = b.i2 = b.j0 = b.j1 = b.j2 = 0;
+    b.d = 0;
+    bytecode_.push_back(b);
+
+    if (verbose()) {
+      userOut() << "SXFunction::init_bytecode: " << algorithm_.size() << " operations decoded into "
+                << (bytecode_.size()-1) << " instructions, " << n_fused
+                << " of which are superinstructions" << endl;
+    }
+  }
+
+  void SXFunction::eval_bytecode(const double** arg, double** res, double* w) const {
+    const BytecodeEl* e = get_ptr(bytecode_);
+
+    // NOTE: Dispatch using computed goto where available (GCC, Clang), jumping
+    // directly from the end of one instruction to the beginning of the next
+#ifdef __GNUC__
+#define CASADI_BC(C) case C: C##_LABEL:
+#define CASADI_BC_NEXT goto *table[(++e)->code]
+    static void* const table[BC_NUM] = {
+      &&BC_GENERIC_LABEL, &&BC_END_LABEL,
+      &&BC_CONST_LABEL, &&BC_INPUT_LABEL, &&BC_OUTPUT_LABEL,
+      &&BC_ADD_LABEL, &&BC_SUB_LABEL, &&BC_MUL_LABEL, &&BC_DIV_LABEL,
+      &&BC_NEG_LABEL, &&BC_SQ_LABEL,
+      &&BC_MULADD_LABEL, &&BC_CONSTMUL_LABEL,
+      &&BC_INPUT_ADD_LABEL, &&BC_INPUT_SUB_LABEL, &&BC_INPUT_MUL_LABEL, &&BC_INPUT_DIV_LABEL,
+      &&BC_ADD_OUTPUT_LABEL, &&BC_SUB_OUTPUT_LABEL, &&BC_MUL_OUTPUT_LABEL,
+      &&BC_DIV_OUTPUT_LABEL};
+    goto *table[e->code];
+#else // __GNUC__
+#define CASADI_BC(C) case C:
+#define CASADI_BC_NEXT continue
+#endif // __GNUC__
+
+    // Switch-based dispatch, only entered without computed goto
+    for (;; ++e) {
+      switch (e->code) {
+      CASADI_BC(BC_GENERIC)
+        switch (e->op) {
+          CASADI_MATH_FUN_BUILTIN(w[e->i1], w[e->i2], w[e->i0])
+        }
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_END)
+        return;
+      CASADI_BC(BC_CONST)
+        w[e->i0] = e->d;
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_INPUT)
+        w[e->i0] = arg[e->i1]==0 ? 0 : arg[e->i1][e->i2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_OUTPUT)
+        if (res[e->i0]!=0) res[e->i0][e->i2] = w[e->i1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_ADD)
+        w[e->i0] = w[e->i1] + w[e->i2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_SUB)
+        w[e->i0] = w[e->i1] - w[e->i2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_MUL)
+        w[e->i0] = w[e->i1] * w[e->i2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_DIV)
+        w[e->i0] = w[e->i1] / w[e->i2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_NEG)
+        w[e->i0] = -w[e->i1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_SQ)
+        w[e->i0] = w[e->i1] * w[e->i1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_MULADD)
+        w[e->i0] = w[e->i1] * w[e->i2];
+        w[e->j0] = w[e->j1] + w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_CONSTMUL)
+        w[e->i0] = e->d;
+        w[e->j0] = w[e->j1] * w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_INPUT_ADD)
+        w[e->i0] = arg[e->i1]==0 ? 0 : arg[e->i1][e->i2];
+        w[e->j0] = w[e->j1] + w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_INPUT_SUB)
+        w[e->i0] = arg[e->i1]==0 ? 0 : arg[e->i1][e->i2];
+        w[e->j0] = w[e->j1] - w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_INPUT_MUL)
+        w[e->i0] = arg[e->i1]==0 ? 0 : arg[e->i1][e->i2];
+        w[e->j0] = w[e->j1] * w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_INPUT_DIV)
+        w[e->i0] = arg[e->i1]==0 ? 0 : arg[e->i1][e->i2];
+        w[e->j0] = w[e->j1] / w[e->j2];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_ADD_OUTPUT)
+        w[e->i0] = w[e->i1] + w[e->i2];
+        if (res[e->j0]!=0) res[e->j0][e->j2] = w[e->j1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_SUB_OUTPUT)
+        w[e->i0] = w[e->i1] - w[e->i2];
+        if (res[e->j0]!=0) res[e->j0][e->j2] = w[e->j1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_MUL_OUTPUT)
+        w[e->i0] = w[e->i1] * w[e->i2];
+        if (res[e->j0]!=0) res[e->j0][e->j2] = w[e->j1];
+        CASADI_BC_NEXT;
+      CASADI_BC(BC_DIV_OUTPUT)
+        w[e->i0] = w[e->i1] / w[e->i2];
+        if (res[e->j0]!=0) res[e->j0][e->j2] = w[e->j1];
+        CASADI_BC_NEXT;
+      }
+    }
+#undef CASADI_BC
+#undef CASADI_BC_NEXT
+  }
+
   SX SXFunction::hess(int iind, int oind) {
     casadi_assert_message(sparsity_out(oind).is_scalar(false), "Function must be scalar");
+    if (hessian_edge_pushing_) {
+      // Lower triangular part, mirrored
+      SX ret = hess_tril(iind, oind);
+      return ret + tril(ret, false).T();
+    }
     SX g = densify(grad(iind, oind));
     if (verbose())  userOut() << "SXFunction::hess: calculating gradient done " << endl;
 
@@ -185,6 +921,34 @@ namespace casadi {
   }
 
   void SXFunction::generateBody(CodeGenerator& g) const {
+    // Split large algorithms into chunks
+    if (g.max_chunk>0 && algorithm_.size()>g.max_chunk) return generate_chunks(g);
+
+    // Run the algorithm
+    generate_algorithm(g, false, true);
+  }
+
+  void SXFunction::generateBatchBody(CodeGenerator& g) const {
+    // Without null pointers, one loop over all instances, vectorizable across instances
+    stringstream nonnull;
+    for (int i=0; i<n_in(); ++i) nonnull << " && arg[" << i << "]";
+    for (int i=0; i<n_out(); ++i) nonnull << " && res[" << i << "]";
+    g.body << "  int i;" << endl
+           << "  if (" << (nonnull.str().empty() ? "1" : nonnull.str().substr(4)) << ") {" << endl
+           << "#pragma omp simd" << endl
+           << "    for (i=0; i<n; ++i) {" << endl;
+    generate_algorithm(g, true, false);
+    g.body << "    }" << endl
+           << "  } else {" << endl
+           << "    for (i=0; i<n; ++i) {" << endl;
+    generate_algorithm(g, true, true);
+    g.body << "    }" << endl
+           << "  }" << endl;
+  }
+
+  void SXFunction::generate_algorithm(CodeGenerator& g, bool batch, bool checked) const {
+    // Indentation
+    string ind = batch ? "      " : "  ";
 
     // Which variables have been declared
     vector<bool> declared(sz_w(), false);
@@ -192,11 +956,15 @@ namespace casadi {
     // Run the algorithm
     for (vector<AlgEl>::const_iterator it = algorithm_.begin(); it!=algorithm_.end(); ++it) {
       // Indent
-      g.body << "  ";
+      g.body << ind;
+
+      // Nonzero index, structure-of-arrays if batched
+      string nz = CodeGenerator::to_string(it->i2);
+      if (batch) nz = it->i2==0 ? "i" : nz + "*n+i";
 
       if (it->op==OP_OUTPUT) {
-        g.body << "if (res[" << it->i0 << "]!=0) "
-                      << "res["<< it->i0 << "][" << it->i2 << "]=" << "a" << it->i1;
+        if (checked) g.body << "if (res[" << it->i0 << "]!=0) ";
+        g.body << "res["<< it->i0 << "][" << nz << "]=" << "a" << it->i1;
       } else {
         // Declare result if not already declared
         if (!declared[it->i0]) {
@@ -211,7 +979,9 @@ namespace casadi {
         if (it->op==OP_CONST) {
           g.body << g.constant(it->d);
         } else if (it->op==OP_INPUT) {
-          g.body << "arg[" << it->i1 << "] ? arg[" << it->i1 << "][" << it->i2 << "] : 0";
+          if (checked) g.body << "arg[" << it->i1 << "] ? ";
+          g.body << "arg[" << it->i1 << "][" << nz << "]";
+          if (checked) g.body << " : 0";
         } else {
           int ndep = casadi_math<double>::ndeps(it->op);
           casadi_math<double>::printPre(it->op, g.body);
@@ -230,6 +1000,84 @@ namespace casadi {
     }
   }
 
+  void SXFunction::generate_chunks(CodeGenerator& g) const {
+    int nc = g.max_chunk;
+
+    // Values used outside the chunk where they are calculated are kept in the work
+    // vector, others in local variables
+    vector<bool> spill(algorithm_.size(), false);
+    vector<int> def(sz_w(), -1);
+    for (int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      int ndep = e.op==OP_OUTPUT ? 1 : casadi_math<double>::ndeps(e.op);
+      if (e.op==OP_CONST || e.op==OP_INPUT) ndep = 0;
+      for (int c=0; c<ndep; ++c) {
+        int d = def[c==0 ? e.i1 : e.i2];
+        if (d>=0 && d/nc != k/nc) spill[d] = true;
+      }
+      if (e.op!=OP_OUTPUT) def[e.i0] = k;
+    }
+
+    // Generate the chunks
+    fill(def.begin(), def.end(), -1);
+    for (int k0=0; k0<algorithm_.size(); k0+=nc) {
+      stringstream s;
+      vector<bool> declared(sz_w(), false);
+      int k1 = min(k0+nc, static_cast<int>(algorithm_.size()));
+      for (int k=k0; k<k1; ++k) {
+        const AlgEl& e = algorithm_[k];
+        s << "  ";
+        if (e.op==OP_OUTPUT) {
+          s << "if (res[" << e.i0 << "]!=0) res[" << e.i0 << "][" << e.i2 << "]="
+            << sx_var(spill, def, e.i1);
+        } else {
+          // Where to store the result
+          string res;
+          if (spill[k]) {
+            res = "w[" + CodeGenerator::to_string(e.i0) + "]";
+          } else {
+            res = "a" + CodeGenerator::to_string(e.i0);
+            if (!declared[e.i0]) {
+              s << "real_t ";
+              declared[e.i0] = true;
+            }
+          }
+          s << res << "=";
+
+          // What to store
+          if (e.op==OP_CONST) {
+            s << g.constant(e.d);
+          } else if (e.op==OP_INPUT) {
+            s << "arg[" << e.i1 << "] ? arg[" << e.i1 << "][" << e.i2 << "] : 0";
+          } else {
+            int ndep = casadi_math<double>::ndeps(e.op);
+            casadi_math<double>::printPre(e.op, s);
+            for (int c=0; c<ndep; ++c) {
+              if (c==0) {
+                s << sx_var(spill, def, e.i1);
+              } else {
+                casadi_math<double>::printSep(e.op, s);
+                s << sx_var(spill, def, e.i2);
+              }
+            }
+            casadi_math<double>::printPost(e.op, s);
+          }
+          def[e.i0] = k;
+        }
+        s << ";" << endl;
+      }
+
+      // Call the chunk
+      g.body << "  " << g.add_chunk(s.str()) << "(arg, res, w);" << endl;
+    }
+  }
+
+  std::string SXFunction::sx_var(const std::vector<bool>& spill, const std::vector<int>& def,
+                                 int i) {
+    if (spill[def[i]]) return "w[" + CodeGenerator::to_string(i) + "]";
+    return "a" + CodeGenerator::to_string(i);
+  }
+
   Options SXFunction::options_
   = {{&FunctionInternal::options_},
      {{"default_in",
@@ -244,7 +1092,32 @@ namespace casadi {
         "Just-in-time compilation for numeric evaluation using OpenCL (experimental)"}},
       {"live_variables",
        {OT_BOOL,
-        "Reuse variables in the work vector"}}
+        "Reuse variables in the work vector"}},
+      {"bytecode",
+       {OT_BOOL,
+        "Evaluate numerically with a pre-decoded bytecode using direct-threaded "
+        "dispatch and fused superinstructions"}},
+      {"cse",
+       {OT_BOOL,
+        "Merge structurally identical subexpressions before sorting the algorithm"}},
+      {"numeric_forward",
+       {OT_BOOL,
+        "Calculate forward directional derivatives numerically by propagating "
+        "tangents through the algorithm, without creating a symbolic derivative function"}},
+      {"numeric_reverse",
+       {OT_BOOL,
+        "Calculate adjoint directional derivatives numerically with a taped reverse "
+        "sweep through the algorithm, without creating a symbolic derivative function"}},
+      {"hessian_edge_pushing",
+       {OT_BOOL,
+        "Calculate Hessians with a second order reverse sweep (edge pushing), rather "
+        "than as the Jacobian of the gradient. Also used for the Hessian blocks of "
+        "functions generated with the factory"}},
+      {"sparsity_width",
+       {OT_INT,
+        "Number of directions propagated in each sweep when calculating Jacobian "
+        "sparsity patterns, a multiple of the bit-vector size (64), default 256. Wider "
+        "bit-vectors need fewer sweeps through the algorithm"}}
      }
   };
 
@@ -255,6 +1128,8 @@ namespace casadi {
 
     // Default (temporary) options
     bool live_variables = true;
+    bool bytecode = false;
+    bool cse = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -262,6 +1137,22 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables = op.second;
+      } else if (op.first=="bytecode") {
+        bytecode = op.second;
+      } else if (op.first=="cse") {
+        cse = op.second;
+      } else if (op.first=="numeric_forward") {
+        numeric_forward_ = op.second;
+      } else if (op.first=="numeric_reverse") {
+        numeric_reverse_ = op.second;
+      } else if (op.first=="hessian_edge_pushing") {
+        hessian_edge_pushing_ = op.second;
+      } else if (op.first=="sparsity_width") {
+        int width = op.second;
+        casadi_assert_message(width>0 && width%bvec_size==0,
+                              "Option 'sparsity_width' must be a positive multiple of "
+                              << bvec_size << ", got " << width);
+        sp_words_ = width/bvec_size;
       } else if (op.first=="just_in_time_opencl") {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
@@ -297,6 +1188,26 @@ namespace casadi {
       }
     }
 
+    // Merge structurally identical subexpressions and sort again
+    if (cse) {
+      for (auto&& n : nodes) if (n) n->temp = 0;
+      out_ = SX::cse(out_);
+      int n_removed = nodes.size();
+      nodes.clear();
+      for (auto&& e : out_) {
+        for (auto&& nz : e.nonzeros()) {
+          s.push(nz.get());
+          sort_depth_first(s, nodes);
+          nodes.push_back(static_cast<SXNode*>(0));
+        }
+      }
+      n_removed -= nodes.size();
+      if (verbose()) {
+        userOut() << "SXFunction::init: common subexpression elimination removed "
+                  << n_removed << " nodes" << endl;
+      }
+    }
+
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
@@ -496,6 +1407,13 @@ namespace casadi {
       }
     }
 
+    // Decode the algorithm for direct-threaded evaluation
+    if (bytecode) {
+      init_bytecode();
+    } else {
+      bytecode_.clear();
+    }
+
     // Initialize just-in-time compilation for numeric evaluation using OpenCL
     if (just_in_time_opencl_) {
 #ifdef WITH_OPENCL
@@ -776,6 +1694,34 @@ namespace casadi {
     if (verbose()) userOut() << "SXFunction::evalAdj end" << endl;
   }
 
+  std::size_t SXFunction::structure_hash() const {
+    std::size_t h = 0;
+    hash_combine(h, n_in());
+    for (int i=0; i<n_in(); ++i) hash_combine(h, sparsity_in(i).hash());
+    hash_combine(h, n_out());
+    for (int i=0; i<n_out(); ++i) hash_combine(h, sparsity_out(i).hash());
+    hash_combine(h, free_vars_.size());
+    for (vector<AlgEl>::const_iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      hash_combine(h, it->op);
+      hash_combine(h, it->i0);
+      switch (it->op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        // Numerical values of constants do not affect the dependency structure
+        break;
+      case OP_INPUT:
+      case OP_OUTPUT:
+        hash_combine(h, it->i1);
+        hash_combine(h, it->i2);
+        break;
+      default:
+        hash_combine(h, it->i1);
+        if (casadi_math<double>::ndeps(it->op)==2) hash_combine(h, it->i2);
+      }
+    }
+    return h;
+  }
+
   void SXFunction::sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
     // Propagate sparsity forward
     for (vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
@@ -826,6 +1772,107 @@ namespace casadi {
     }
   }
 
+  /// Propagate sparsity forward, NW words per nonzero (nw if NW==0)
+  template<int NW>
+  static void sp_fwd_words(const vector<SXFunction::AlgEl>& algorithm, const bvec_t** arg,
+                           bvec_t** res, bvec_t* w, int nw) {
+    if (NW>0) nw = NW;
+    for (auto&& e : algorithm) {
+      bvec_t* w0 = w + e.i0*nw;
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        for (int k=0; k<nw; ++k) w0[k] = 0;
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]==0) {
+          for (int k=0; k<nw; ++k) w0[k] = 0;
+        } else {
+          const bvec_t* a = arg[e.i1] + e.i2*nw;
+          for (int k=0; k<nw; ++k) w0[k] = a[k];
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=0) {
+          bvec_t* r = res[e.i0] + e.i2*nw;
+          const bvec_t* w1 = w + e.i1*nw;
+          for (int k=0; k<nw; ++k) r[k] = w1[k];
+        }
+        break;
+      default: // Unary or binary operation
+        {
+          const bvec_t* w1 = w + e.i1*nw;
+          const bvec_t* w2 = w + e.i2*nw;
+          for (int k=0; k<nw; ++k) w0[k] = w1[k] | w2[k];
+        }
+      }
+    }
+  }
+
+  /// Propagate sparsity backwards, NW words per nonzero (nw if NW==0)
+  template<int NW>
+  static void sp_rev_words(const vector<SXFunction::AlgEl>& algorithm, bvec_t** arg,
+                           bvec_t** res, bvec_t* w, int nw) {
+    if (NW>0) nw = NW;
+    for (auto e=algorithm.rbegin(); e!=algorithm.rend(); ++e) {
+      bvec_t* w0 = w + e->i0*nw;
+      switch (e->op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        for (int k=0; k<nw; ++k) w0[k] = 0;
+        break;
+      case OP_INPUT:
+        if (arg[e->i1]!=0) {
+          bvec_t* a = arg[e->i1] + e->i2*nw;
+          for (int k=0; k<nw; ++k) a[k] |= w0[k];
+        }
+        for (int k=0; k<nw; ++k) w0[k] = 0;
+        break;
+      case OP_OUTPUT:
+        if (res[e->i0]!=0) {
+          bvec_t* r = res[e->i0] + e->i2*nw;
+          bvec_t* w1 = w + e->i1*nw;
+          for (int k=0; k<nw; ++k) {
+            w1[k] |= r[k];
+            r[k] = 0;
+          }
+        }
+        break;
+      default: // Unary or binary operation
+        {
+          bvec_t* w1 = w + e->i1*nw;
+          bvec_t* w2 = w + e->i2*nw;
+          for (int k=0; k<nw; ++k) {
+            bvec_t seed = w0[k];
+            w0[k] = 0;
+            w1[k] |= seed;
+            w2[k] |= seed;
+          }
+        }
+      }
+    }
+  }
+
+  void SXFunction::sp_fwd_wide(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    // Fixed widths are unrolled and vectorized by the compiler
+    switch (sp_words_) {
+    case 2: sp_fwd_words<2>(algorithm_, arg, res, w, 2); break;
+    case 4: sp_fwd_words<4>(algorithm_, arg, res, w, 4); break;
+    case 8: sp_fwd_words<8>(algorithm_, arg, res, w, 8); break;
+    default: sp_fwd_words<0>(algorithm_, arg, res, w, sp_words_);
+    }
+  }
+
+  void SXFunction::sp_rev_wide(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    fill_n(w, sz_w()*sp_words_, 0);
+    switch (sp_words_) {
+    case 2: sp_rev_words<2>(algorithm_, arg, res, w, 2); break;
+    case 4: sp_rev_words<4>(algorithm_, arg, res, w, 4); break;
+    case 8: sp_rev_words<8>(algorithm_, arg, res, w, 8); break;
+    default: sp_rev_words<0>(algorithm_, arg, res, w, sp_words_);
+    }
+  }
+
   Function SXFunction::getFullJacobian() {
     SX J = SX::jacobian(veccat(out_), veccat(in_));
     return Function(name_ + "_jac", in_, {J});
@@ -48,6 +48,49 @@ namespace casadi {
     };
   };
 
+  /** \brief Recorded edge pushing sweep, see SXFunction::ep_record
+      The structure of the sweep only depends on the algorithm, so it is recorded once
+      as a list of multiply-accumulate instructions on the partial derivatives (d, h),
+      the adjoints (a) and the edges (s), which are then replayed for each evaluation.
+  */
+  struct EPTape {
+    /// Instructions
+    enum Op {
+      EP_PUSH,    // s[dst] += d[i1]*s[src]
+      EP_PUSH2,   // s[dst] += 2*d[i1]*s[src]
+      EP_PUSHSQ,  // s[dst] += d[i1]*d[i2]*s[src]
+      EP_CREATE,  // s[dst] += a[src]*h[i1]
+      EP_ADJ      // a[dst] += a[src]*d[i1]
+    };
+    struct Instr { int op, dst, src, i1, i2;};
+    std::vector<Instr> instr;
+
+    /// Active arguments of an operation
+    enum Kind {
+      EP_INACTIVE,  // No dependence on the input
+      EP_SAME,      // Same variable twice, collapsed to a unary operation
+      EP_FIRST,     // First argument only
+      EP_SECOND,    // Second argument only
+      EP_BOTH       // Both arguments
+    };
+    std::vector<char> kind;
+
+    /// Variable with a unit adjoint seed, -1 if none
+    int seed;
+
+    /// Number of edges
+    int n_edge;
+
+    /// Lower triangular part: rows, columns (nonzeros of the input) and edges
+    std::vector<int> row, col, edge;
+
+    /// Work vector for the second order partial derivatives of the operations
+    size_t sz_wh;
+
+    /// Length of the work vector of SXFunction::ep_eval
+    size_t sz_w;
+  };
+
 #ifdef WITH_OPENCL
   /** \brief Singleton for the sparsity propagation kernel
       TODO: Move to a separate file and make non sparsity pattern specific
@@ -206,9 +249,113 @@ class CASADI_EXPORT SXFunction :
     T d[2];
   };
 
+  /** \brief  An instruction of the pre-decoded bytecode
+      Superinstructions perform two consecutive atomic operations, (i0, i1, i2)
+      followed by (j0, j1, j2)
+  */
+  struct BytecodeEl {
+    int code;   /// Bytecode instruction
+    int op;     /// Operator index, for instructions not handled by a dedicated bytecode
+    int i0, i1, i2;
+    int j0, j1, j2;
+    double d;
+  };
+
   /** \brief  all binary nodes of the tree in the order of execution */
   std::vector<AlgEl> algorithm_;
 
+  /** \brief  algorithm_ decoded for direct-threaded evaluation, empty if not used */
+  std::vector<BytecodeEl> bytecode_;
+
+  /** \brief  Decode the algorithm into bytecode, fusing common instruction pairs */
+  void init_bytecode();
+
+  /** \brief  Evaluate numerically using the bytecode */
+  void eval_bytecode(const double** arg, double** res, double* w) const;
+
+  /** \brief  Evaluate numerically along with forward directional derivatives
+      The tangents are propagated alongside the values in a single pass through the
+      algorithm. Seeds and sensitivities are stored direction by direction, as in
+      the inputs and outputs of the forward derivative function. The work vector
+      must have length sz_w()*(1+nfwd).
+  */
+  void eval_fwd(const double** arg, double** res, const double** fseed, double** fsens,
+                int nfwd, double* w) const;
+
+  /** \brief  Evaluate numerically along with adjoint directional derivatives
+      The partial derivatives of all operations are recorded on a tape during a
+      forward sweep through the algorithm and then used in a reverse sweep.
+      Seeds and sensitivities are stored direction by direction, as in the inputs
+      and outputs of the reverse derivative function. The work vector must have
+      length sz_w()*(1+nadj) + 2*operations_.size().
+  */
+  void eval_adj(const double** arg, double** res, const double** aseed, double** asens,
+                int nadj, double* w) const;
+
+  /** \brief  Lower triangular part of a Hessian by edge pushing
+      Second order reverse sweep through the algorithm (Gower and Mello), which
+      propagates the nonlinear interactions between the variables as a symmetric
+      set of edges. The result is the lower triangular part of the Hessian of the
+      (scalar) output \a oind with respect to input \a iind, as triplets with
+      nonzero indices of the input. The structure only depends on the algorithm,
+      so it is the same for numeric (T=double) and symbolic (T=SXElem) evaluation.
+  */
+  template<typename T>
+  void hess_edge_pushing(const T** arg, int iind, int oind, std::vector<int>& row,
+                         std::vector<int>& col, std::vector<T>& val) const;
+
+  /** \brief  Record the edge pushing sweep of hess_edge_pushing
+      Also creates the second order partial derivatives of the operations, so that
+      ep_eval does not need to allocate memory.
+  */
+  void ep_record(int iind, int oind, EPTape& tape) const;
+
+  /** \brief  Replay a recorded edge pushing sweep
+      The work vector must have length tape.sz_w. Returns the values of the edges,
+      located in the work vector.
+  */
+  template<typename T>
+  const T* ep_eval(const EPTape& tape, const T** arg, T* w) const;
+
+  /** \brief Lower triangular part of a Hessian by edge pushing, symbolically */
+  SX hess_tril(int iind=0, int oind=0);
+
+  /** \brief Second order partial derivatives of an operation, created on demand
+      Outputs are d2f/dx2, d2f/dxdy and d2f/dy2 of the operation with inputs x and y.
+   */
+  const Function& op_hess(int op) const;
+
+  ///@{
+  /** \brief Generate a function that calculates \a nfwd forward derivatives */
+  virtual Function get_forward(const std::string& name, int nfwd,
+                               const std::vector<std::string>& i_names,
+                               const std::vector<std::string>& o_names,
+                               const Dict& opts);
+  ///@}
+
+  ///@{
+  /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+  virtual Function get_reverse(const std::string& name, int nadj,
+                               const std::vector<std::string>& i_names,
+                               const std::vector<std::string>& o_names,
+                               const Dict& opts);
+  ///@}
+
+  /** \brief  Numeric forward mode, rather than a symbolic derivative function */
+  bool numeric_forward_;
+
+  /** \brief  Numeric reverse mode, rather than a symbolic derivative function */
+  bool numeric_reverse_;
+
+  /** \brief  Number of bvec_t words per nonzero when calculating Jacobian sparsity */
+  int sp_words_;
+
+  /** \brief  Hessians by edge pushing, rather than as the Jacobian of the gradient */
+  bool hessian_edge_pushing_;
+
+  /** \brief  Second order partial derivatives of the operations, by operation index */
+  mutable std::map<int, Function> op_hess_;
+
   /// work vector for symbolic calculations (allocated first time)
   std::vector<SXElem> s_work_;
   std::vector<SXElem> free_vars_;
@@ -237,12 +384,44 @@ class CASADI_EXPORT SXFunction :
   /** \brief Generate code for the body of the C function */
   virtual void generateBody(CodeGenerator& g) const;
 
+  /** \brief Batched variants are supported without free variables */
+  virtual bool has_batch() const { return free_vars_.empty();}
+
+  /** \brief Generate code for the body of the batched variant */
+  virtual void generateBatchBody(CodeGenerator& g) const;
+
+  /** \brief Generate code for the algorithm, for one or (batched) n instances
+      Without \a checked, all inputs and outputs are assumed to be non-null */
+  void generate_algorithm(CodeGenerator& g, bool batch, bool checked) const;
+
+  /** \brief Generate code in chunks of at most max_chunk operations */
+  void generate_chunks(CodeGenerator& g) const;
+
+  /** \brief Name of a work vector element in generated chunks */
+  static std::string sx_var(const std::vector<bool>& spill, const std::vector<int>& def,
+                            int i);
+
   /** \brief  Propagate sparsity forward */
   virtual void sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
 
   /** \brief  Propagate sparsity backwards */
   virtual void sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
 
+  /** \brief  Sparsity propagation only touches the work vectors passed */
+  virtual bool has_sp_parallel() const { return !just_in_time_sparsity_;}
+
+  /** \brief  Hash of the algorithm and the input and output sparsity patterns */
+  virtual std::size_t structure_hash() const;
+
+  /** \brief  Number of bvec_t words per nonzero in wide sparsity propagation */
+  virtual int sp_words() const { return sp_words_;}
+
+  /** \brief  Propagate sparsity forward, sp_words() words per nonzero */
+  virtual void sp_fwd_wide(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+  /** \brief  Propagate sparsity backwards, sp_words() words per nonzero */
+  virtual void sp_rev_wide(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
   /** \brief Return Jacobian of all input elements with respect to all output elements */
   virtual Function getFullJacobian();
 
@@ -0,0 +1,93 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_hessian.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Function SXHessian::create(const std::string& name, const Function& f, int iind, int oind,
+                             const Dict& opts) {
+    string h_name = "hess_" + f.name_out(oind) + "_" + f.name_in(iind) + "_" + f.name_in(iind);
+    return instantiate(new SXHessian(name, f, iind, oind), f.name_in(), {h_name}, opts);
+  }
+
+  SXHessian::SXHessian(const std::string& name, const Function& f, int iind, int oind)
+    : SXNumeric(name, f), iind_(iind), oind_(oind) {
+    const SXFunction* fi = static_cast<const SXFunction*>(f_.get());
+
+    // The structure does not depend on the values, record the sweep once
+    fi->ep_record(iind_, oind_, tape_);
+
+    // Sparsity pattern, with rows and columns corresponding to elements of the input
+    const Sparsity& sp = f_.sparsity_in(iind_);
+    vector<int> ind = sp.find(), row = tape_.row, col = tape_.col, mapping;
+    for (int& r : row) r = ind[r];
+    for (int& c : col) c = ind[c];
+    sp_ = Sparsity::triplet(sp.numel(), sp.numel(), row, col, mapping, false);
+
+    // Edge for each nonzero of the Hessian
+    edge_.resize(mapping.size());
+    for (int k=0; k<mapping.size(); ++k) edge_[k] = tape_.edge[mapping[k]];
+  }
+
+  SXHessian::~SXHessian() {
+  }
+
+  void SXHessian::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    SXNumeric::init(opts);
+
+    // Allocate work vector for the edge pushing sweep
+    alloc_w(tape_.sz_w);
+  }
+
+  void SXHessian::eval(void* mem, const double** arg, double** res, int* iw, double* w) const {
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    casadi_assert_message(!f->has_free(), "Cannot evaluate \"" + f_.name() + "\" numerically"
+                          " since it has free variables");
+    const double* s = f->ep_eval(tape_, arg, w);
+    if (res[0]) {
+      for (int k=0; k<edge_.size(); ++k) res[0][k] = s[edge_[k]];
+    }
+  }
+
+  void SXHessian::eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem) {
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    const SXElem* s = f->ep_eval(tape_, arg, w);
+    if (res[0]) {
+      for (int k=0; k<edge_.size(); ++k) res[0][k] = s[edge_[k]];
+    }
+  }
+
+  Function SXHessian::get_symbolic() {
+    SXFunction* f = static_cast<SXFunction*>(f_.get());
+    SX h = f->hess_tril(iind_, oind_);
+    return Function(name_, f->in_, {project(h, sp_)}, ischeme_, oscheme_, f->derived_options());
+  }
+
+} // namespace casadi
@@ -0,0 +1,99 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SX_HESSIAN_HPP
+#define CASADI_SX_HESSIAN_HPP
+
+#include "sx_numeric.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Lower triangular part of the Hessian of an SXFunction, by edge pushing
+
+      Has the inputs of the SXFunction and a single output, the lower triangular part
+      of the Hessian of a scalar output with respect to an input. Evaluated with a
+      second order reverse sweep through the algorithm of the SXFunction, see
+      SXFunction::hess_edge_pushing, both numerically and symbolically. The sweep is
+      recorded on construction and replayed in the work vector.
+  */
+  class CASADI_EXPORT SXHessian : public SXNumeric {
+  public:
+    // Create function (use instead of constructor)
+    static Function create(const std::string& name, const Function& f, int iind, int oind,
+                           const Dict& opts);
+
+    /** \brief Destructor */
+    virtual ~SXHessian();
+
+    /** \brief Get type name */
+    virtual std::string type_name() const { return "sxhessian";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    virtual size_t get_n_in() { return f_.n_in();}
+    virtual size_t get_n_out() { return 1;}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    virtual Sparsity get_sparsity_in(int i) { return f_.sparsity_in(i);}
+    virtual Sparsity get_sparsity_out(int i) { return sp_;}
+    /// @}
+
+    /** \brief  Initialize */
+    virtual void init(const Dict& opts);
+
+    /** \brief  Evaluate numerically, work vectors given */
+    virtual void eval(void* mem, const double** arg, double** res, int* iw, double* w) const;
+
+    /** \brief  Evaluate symbolically */
+    virtual void eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem);
+
+  protected:
+    // Constructor (protected, use create function)
+    SXHessian(const std::string& name, const Function& f, int iind, int oind);
+
+    // Create the equivalent symbolic function
+    virtual Function get_symbolic();
+
+    // Input and output
+    int iind_, oind_;
+
+    // Sparsity pattern of the lower triangular part of the Hessian
+    Sparsity sp_;
+
+    // Recorded edge pushing sweep
+    EPTape tape_;
+
+    // Edge of the sweep for each nonzero of the Hessian
+    std::vector<int> edge_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_HESSIAN_HPP
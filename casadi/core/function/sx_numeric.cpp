@@ -0,0 +1,91 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "sx_numeric.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  SXNumeric::SXNumeric(const std::string& name, const Function& f)
+    : FunctionInternal(name), f_(f) {
+    casadi_assert(f_.is_a("sxfunction"));
+  }
+
+  SXNumeric::~SXNumeric() {
+  }
+
+  Function SXNumeric::instantiate(SXNumeric* node, const std::vector<std::string>& i_names,
+                                  const std::vector<std::string>& o_names, const Dict& opts) {
+    Function ret;
+    ret.assignNode(node);
+    Dict opts2 = opts;
+    opts2["input_scheme"] = i_names;
+    opts2["output_scheme"] = o_names;
+    ret->construct(opts2);
+    return ret;
+  }
+
+  Function& SXNumeric::symbolic() {
+    if (sym_.is_null()) sym_ = get_symbolic();
+    return sym_;
+  }
+
+  void SXNumeric::eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem) {
+    symbolic()(vector<const SXElem*>(arg, arg+n_in()), vector<SXElem*>(res, res+n_out()));
+  }
+
+  void SXNumeric::sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    symbolic()(vector<const bvec_t*>(arg, arg+n_in()), vector<bvec_t*>(res, res+n_out()));
+  }
+
+  void SXNumeric::sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    // Work vectors of the symbolic function
+    Function& sym = symbolic();
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    sym.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    vector<bvec_t*> arg1(sz_arg), res1(sz_res);
+    copy_n(arg, n_in(), arg1.begin());
+    copy_n(res, n_out(), res1.begin());
+    vector<int> iw1(sz_iw);
+    vector<bvec_t> w1(sz_w);
+    sym->sp_rev(get_ptr(arg1), get_ptr(res1), get_ptr(iw1), get_ptr(w1), 0);
+  }
+
+  Function SXNumeric::get_forward(const std::string& name, int nfwd,
+                                  const std::vector<std::string>& i_names,
+                                  const std::vector<std::string>& o_names,
+                                  const Dict& opts) {
+    return symbolic().forward(nfwd);
+  }
+
+  Function SXNumeric::get_reverse(const std::string& name, int nadj,
+                                  const std::vector<std::string>& i_names,
+                                  const std::vector<std::string>& o_names,
+                                  const Dict& opts) {
+    return symbolic().reverse(nadj);
+  }
+
+} // namespace casadi
@@ -0,0 +1,103 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef CASADI_SX_NUMERIC_HPP
+#define CASADI_SX_NUMERIC_HPP
+
+#include "sx_function.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Base class for functions evaluated numerically through an SXFunction
+
+      Derived classes (SXForward, SXReverse, SXHessian) evaluate a derivative of an
+      SXFunction with a dedicated sweep through its algorithm. An equivalent symbolic
+      function is created on demand for the remaining operations: symbolic evaluation,
+      sparsity propagation and derivatives.
+  */
+  class CASADI_EXPORT SXNumeric : public FunctionInternal {
+  public:
+    /** \brief Destructor */
+    virtual ~SXNumeric() = 0;
+
+    /** \brief  Evaluate symbolically, using the symbolic function */
+    virtual void eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem);
+
+    /** \brief  Propagate sparsity forward */
+    virtual void sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+    /** \brief  Propagate sparsity backwards */
+    virtual void sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+    ///@{
+    /// Is the class able to propagate seeds through the algorithm?
+    virtual bool has_spfwd() const { return true;}
+    virtual bool has_sprev() const { return true;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    virtual Function get_forward(const std::string& name, int nfwd,
+                                 const std::vector<std::string>& i_names,
+                                 const std::vector<std::string>& o_names,
+                                 const Dict& opts);
+    virtual int get_n_forward() const { return 64;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    virtual Function get_reverse(const std::string& name, int nadj,
+                                 const std::vector<std::string>& i_names,
+                                 const std::vector<std::string>& o_names,
+                                 const Dict& opts);
+    virtual int get_n_reverse() const { return 64;}
+    ///@}
+
+  protected:
+    // Constructor (protected, use the create functions of the derived classes)
+    SXNumeric(const std::string& name, const Function& f);
+
+    // Construct a newly allocated instance with a given input and output scheme
+    static Function instantiate(SXNumeric* node, const std::vector<std::string>& i_names,
+                                const std::vector<std::string>& o_names, const Dict& opts);
+
+    // Create the equivalent symbolic function
+    virtual Function get_symbolic() = 0;
+
+    // Equivalent symbolic function, created on demand
+    Function& symbolic();
+
+    // The SXFunction being differentiated
+    Function f_;
+
+    // Equivalent symbolic function, if created
+    Function sym_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_NUMERIC_HPP
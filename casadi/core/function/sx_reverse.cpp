@@ -0,0 +1,88 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_reverse.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  Function SXReverse::create(const std::string& name, const Function& f, int nadj,
+                             const std::vector<std::string>& i_names,
+                             const std::vector<std::string>& o_names,
+                             const Dict& opts) {
+    return instantiate(new SXReverse(name, f, nadj), i_names, o_names, opts);
+  }
+
+  SXReverse::SXReverse(const std::string& name, const Function& f, int nadj)
+    : SXNumeric(name, f), nadj_(nadj) {
+  }
+
+  SXReverse::~SXReverse() {
+  }
+
+  Sparsity SXReverse::get_sparsity_in(int i) {
+    int n_in = f_.n_in(), n_out = f_.n_out();
+    if (i<n_in) {
+      return f_.sparsity_in(i);
+    } else if (i<n_in+n_out) {
+      return Sparsity(f_.size_out(i-n_in));
+    } else {
+      return repmat(f_.sparsity_out(i-n_in-n_out), 1, nadj_);
+    }
+  }
+
+  Sparsity SXReverse::get_sparsity_out(int i) {
+    return repmat(f_.sparsity_in(i), 1, nadj_);
+  }
+
+  void SXReverse::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    SXNumeric::init(opts);
+
+    // Values, followed by the tape and the adjoints
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    alloc_w(f_.sz_w()*(1+nadj_) + 2*f->operations_.size());
+
+    if (verbose()) {
+      log("SXReverse::init", "Propagating " + to_string(nadj_) + " adjoints through "
+          + f_.name() + " numerically");
+    }
+  }
+
+  void SXReverse::eval(void* mem, const double** arg, double** res, int* iw, double* w) const {
+    int n_in = f_.n_in(), n_out = f_.n_out();
+    const SXFunction* f = static_cast<const SXFunction*>(f_.get());
+    f->eval_adj(arg, 0, arg + n_in + n_out, res, nadj_, w);
+  }
+
+  Function SXReverse::get_symbolic() {
+    SXFunction* f = static_cast<SXFunction*>(f_.get());
+    return f->XFunction<SXFunction, SX, SXNode>::get_reverse(name_, nadj_, ischeme_, oscheme_,
+                                                             f->derived_options());
+  }
+
+} // namespace casadi
@@ -0,0 +1,88 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SX_REVERSE_HPP
+#define CASADI_SX_REVERSE_HPP
+
+#include "sx_numeric.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Adjoint derivatives of an SXFunction, calculated numerically
+
+      Has the inputs and outputs of a reverse derivative function, but is evaluated
+      with a taped reverse sweep through the algorithm of the SXFunction, see
+      SXFunction::eval_adj. No symbolic expressions are created unless derivatives
+      of this function are requested.
+  */
+  class CASADI_EXPORT SXReverse : public SXNumeric {
+  public:
+    // Create function (use instead of constructor)
+    static Function create(const std::string& name, const Function& f, int nadj,
+                           const std::vector<std::string>& i_names,
+                           const std::vector<std::string>& o_names,
+                           const Dict& opts);
+
+    /** \brief Destructor */
+    virtual ~SXReverse();
+
+    /** \brief Get type name */
+    virtual std::string type_name() const { return "sxreverse";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    virtual size_t get_n_in() { return f_.n_in() + 2*f_.n_out();}
+    virtual size_t get_n_out() { return f_.n_in();}
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    virtual Sparsity get_sparsity_in(int i);
+    virtual Sparsity get_sparsity_out(int i);
+    /// @}
+
+    /** \brief  Initialize */
+    virtual void init(const Dict& opts);
+
+    /** \brief  Evaluate numerically, work vectors given */
+    virtual void eval(void* mem, const double** arg, double** res, int* iw, double* w) const;
+
+  protected:
+    // Constructor (protected, use create function)
+    SXReverse(const std::string& name, const Function& f, int nadj);
+
+    // Create the equivalent symbolic function
+    virtual Function get_symbolic();
+
+    // Number of adjoint directions
+    int nadj_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_REVERSE_HPP
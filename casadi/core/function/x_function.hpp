@@ -1210,6 +1210,8 @@ namespace casadi {
 
     // Create an expression factory
     Factory<MatType> f(aux);
+    auto ep = opts.find("hessian_edge_pushing");
+    if (ep!=opts.end()) f.hessian_edge_pushing_ = ep->second;
     for (int i=0; i<in_.size(); ++i) f.add_input(ischeme_[i], in_[i]);
     for (int i=0; i<out_.size(); ++i) f.add_output(oscheme_[i], out_[i]);
 
@@ -33,4 +33,12 @@ namespace casadi {
 
   std::string GlobalOptions::casadipath = "";
 
+  std::string GlobalOptions::sparsity_cache = "";
+
+  std::string GlobalOptions::jit_cache = "";
+
+  int GlobalOptions::jit_cache_size = 256;
+
+  int GlobalOptions::blas_threshold = 4096;
+
 } // namespace casadi
@@ -61,6 +61,27 @@ namespace casadi {
 
       static bool hierarchical_sparsity;
 
+      /** \brief Directory of the persistent Jacobian sparsity and coloring cache
+      * Empty string (default) disables the cache
+      */
+      static std::string sparsity_cache;
+
+      /** \brief Directory of the persistent cache of JIT compiled shared libraries
+      * Used by the "shell" compiler. Empty string (default) disables the cache
+      */
+      static std::string jit_cache;
+
+      /** \brief Maximum size of the JIT cache in megabytes
+      * Least recently used entries are removed first. Default: 256
+      */
+      static int jit_cache_size;
+
+      /** \brief Minimum number of multiply-adds for a dense matrix product to be passed to BLAS
+      * Only has an effect if CasADi was compiled with BLAS support (WITH_BLAS).
+      * A negative value disables BLAS. Default: 4096
+      */
+      static int blas_threshold;
+
 #endif //SWIG
       // Setter and getter for simplification_on_the_fly
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
@@ -70,6 +91,22 @@ namespace casadi {
       static void setHierarchicalSparsity(bool flag) { hierarchical_sparsity = flag; }
       static bool getHierarchicalSparsity() { return hierarchical_sparsity; }
 
+      // Setter and getter for sparsity_cache
+      static void setSparsityCache(const std::string& dir) { sparsity_cache = dir; }
+      static std::string getSparsityCache() { return sparsity_cache; }
+
+      // Setter and getter for jit_cache
+      static void setJitCache(const std::string& dir) { jit_cache = dir; }
+      static std::string getJitCache() { return jit_cache; }
+
+      // Setter and getter for jit_cache_size
+      static void setJitCacheSize(int mb) { jit_cache_size = mb; }
+      static int getJitCacheSize() { return jit_cache_size; }
+
+      // Setter and getter for blas_threshold
+      static void setBlasThreshold(int n) { blas_threshold = n; }
+      static int getBlasThreshold() { return blas_threshold; }
+
       static void setCasadiPath(const std::string & path) { casadipath = path; }
       static std::string getCasadiPath() { return casadipath; }
 
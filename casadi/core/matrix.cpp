@@ -26,7 +26,11 @@
 #include "matrix_impl.hpp"
 #include "function/sx_function.hpp"
 #include "sx/sx_node.hpp"
+#include "sx/binary_sx.hpp"
+#include "sx/unary_sx.hpp"
 #include "function/linsol.hpp"
+#include <cstring>
+#include <unordered_map>
 
 using namespace std;
 
@@ -1031,6 +1035,111 @@ namespace casadi {
     return vertcat(ret);
   }
 
+  template<>
+  vector<SX> SX::cse(const vector<SX>& e) {
+    // Sort the expressions
+    Function f("tmp", vector<SX>(), e);
+    auto *ff = dynamic_cast<SXFunction *>(f.get());
+
+    // Key identifying a node: operation and (canonical) dependencies
+    struct NodeKey {
+      int op;
+      const SXNode *dep0, *dep1;
+      bool operator==(const NodeKey& k) const {
+        return op==k.op && dep0==k.dep0 && dep1==k.dep1;
+      }
+    };
+    struct NodeKeyHash {
+      size_t operator()(const NodeKey& k) const {
+        size_t h = hash<const SXNode*>()(k.dep0);
+        h ^= hash<const SXNode*>()(k.dep1) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= hash<int>()(k.op) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+      }
+    };
+
+    // Unique operations, unique constants (compared bitwise, so that e.g. 0 and -0 differ)
+    unordered_map<NodeKey, SXElem, NodeKeyHash> ops;
+    unordered_map<unsigned long long, SXElem> consts; // NOLINT(runtime/int)
+
+    // Work vector with the canonical node for each element
+    vector<SXElem> w(f.getWorkSize());
+
+    // Iterators to the operations, constants and free variables
+    vector<SXElem>::const_iterator b_it = ff->operations_.begin();
+    vector<SXElem>::const_iterator c_it = ff->constants_.begin();
+    vector<SXElem>::const_iterator p_it = ff->free_vars_.begin();
+
+    // Return value, with the same sparsity patterns
+    vector<SX> ret(e.size());
+    for (int i=0; i<ret.size(); ++i) ret[i] = SX::zeros(e[i].sparsity());
+
+    // Pass through the algorithm
+    for (auto&& a : ff->algorithm_) {
+      switch (a.op) {
+      case OP_OUTPUT:
+        ret[a.i0].nonzeros().at(a.i2) = w[a.i1];
+        break;
+      case OP_PARAMETER:
+        w[a.i0] = *p_it++;
+        break;
+      case OP_CONST:
+        {
+          unsigned long long bits; // NOLINT(runtime/int)
+          casadi_assert(sizeof(bits)==sizeof(a.d));
+          memcpy(&bits, &a.d, sizeof(bits));
+          auto it = consts.find(bits);
+          if (it==consts.end()) {
+            w[a.i0] = consts[bits] = *c_it;
+          } else {
+            w[a.i0] = it->second;
+          }
+          c_it++;
+        }
+        break;
+      default:
+        {
+          // Original node and its canonical dependencies
+          const SXElem& x = *b_it++;
+          bool binary = casadi_math<double>::ndeps(a.op)==2;
+          const SXElem& d0 = w[a.i1];
+          const SXElem& d1 = w[a.i2];
+
+          // Normalize the ordering of the arguments of commutative operations
+          NodeKey key = {a.op, d0.get(), binary ? d1.get() : 0};
+          if (binary && operation_checker<CommChecker>(a.op) && key.dep1<key.dep0) {
+            swap(key.dep0, key.dep1);
+          }
+
+          // Look for a structurally identical node
+          auto it = ops.find(key);
+          if (it!=ops.end()) {
+            w[a.i0] = it->second;
+            continue;
+          }
+
+          // Reuse the original node if its dependencies are unchanged
+          SXElem r;
+          if (x.dep(0).get()==d0.get() && (!binary || x.dep(1).get()==d1.get())) {
+            r = x;
+          } else if (binary) {
+            r = BinarySX::create(a.op, d0, d1);
+          } else {
+            r = UnarySX::create(a.op, d0);
+          }
+          w[a.i0] = ops[key] = r;
+        }
+      }
+    }
+
+    return ret;
+  }
+
+  template<>
+  SX SX::cse(const SX& e) {
+    return cse(vector<SX>{e}).front();
+  }
+
   template<>
   void SX::print_split(vector<string>& nz,
                       vector<string>& inter) const {
@@ -419,6 +419,8 @@ namespace casadi {
     static Matrix<Scalar> poly_coeff(const Matrix<Scalar>& ex, const Matrix<Scalar>&x);
     static Matrix<Scalar> poly_roots(const Matrix<Scalar>& p);
     static Matrix<Scalar> eig_symbolic(const Matrix<Scalar>& m);
+    static Matrix<Scalar> cse(const Matrix<Scalar>& e);
+    static std::vector<Matrix<Scalar> > cse(const std::vector<Matrix<Scalar> >& e);
     static void qr(const Matrix<Scalar>& A, Matrix<Scalar>& Q, Matrix<Scalar>& R);
     static Matrix<Scalar> all(const Matrix<Scalar>& x);
     static Matrix<Scalar> any(const Matrix<Scalar>& x);
@@ -715,6 +717,19 @@ namespace casadi {
     friend inline Matrix<Scalar> eig_symbolic(const Matrix<Scalar>& m) {
       return Matrix<Scalar>::eig_symbolic(m);
     }
+
+    ///@{
+    /** \brief Common subexpression elimination
+     *  Merges structurally identical nodes (same operation and same dependencies,
+     *  up to the ordering of commutative operations) as well as equal constants.
+     */
+    friend inline Matrix<Scalar> cse(const Matrix<Scalar>& e) {
+      return Matrix<Scalar>::cse(e);
+    }
+    friend inline std::vector<Matrix<Scalar> > cse(const std::vector<Matrix<Scalar> >& e) {
+      return Matrix<Scalar>::cse(e);
+    }
+    ///@}
 /** @} */
 #endif
 
@@ -28,6 +28,7 @@
 #include "function/function.hpp"
 
 #include "casadi_interrupt.hpp"
+#include "casadi_blas.hpp"
 
 /// \cond INTERNAL
 
@@ -1017,6 +1018,8 @@ namespace casadi {
     } else {
       // Carry out the matrix product
       Matrix<Scalar> ret = z;
+      if (casadi_blas_mtimes(x.ptr(), x.sparsity(), y.ptr(), y.sparsity(),
+                             ret.ptr(), ret.sparsity())) return ret;
       std::vector<Scalar> work(x.size1());
       casadi_mtimes(x.ptr(), x.sparsity(), y.ptr(), y.sparsity(),
                     ret.ptr(), ret.sparsity(), get_ptr(work), false);
@@ -2375,6 +2378,16 @@ namespace casadi {
     throw CasadiException("\"eig_symbolic\" not defined for instantiation");
   }
 
+  template<typename Scalar>
+  Matrix<Scalar> Matrix<Scalar>::cse(const Matrix<Scalar>& e) {
+    throw CasadiException("\"cse\" not defined for instantiation");
+  }
+
+  template<typename Scalar>
+  std::vector<Matrix<Scalar> > Matrix<Scalar>::cse(const std::vector<Matrix<Scalar> >& e) {
+    throw CasadiException("\"cse\" not defined for instantiation");
+  }
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::sparsify(const Matrix<Scalar>& x, double tol) {
     // Quick return if there are no entries to be removed
@@ -2642,6 +2655,8 @@ namespace casadi {
   template<> SX SX::poly_coeff(const SX& f, const SX& x);
   template<> SX SX::poly_roots(const SX& p);
   template<> SX SX::eig_symbolic(const SX& m);
+  template<> SX SX::cse(const SX& e);
+  template<> std::vector<SX> SX::cse(const std::vector<SX>& e);
   template<> void SX::print_split(std::vector<std::string>& nz,
                                  std::vector<std::string>& inter) const;
 
@@ -84,7 +84,9 @@ namespace casadi {
   }
 
   void Call::eval(const double** arg, double** res, int* iw, double* w, int mem) const {
-    fcn_(arg, res, iw, w, mem);
+    // Concurrent calls of the same function must not share a memory object
+    ScopedCheckout m(fcn_);
+    fcn_(arg, res, iw, w, m);
   }
 
   int Call::nout() const {
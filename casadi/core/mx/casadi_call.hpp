@@ -131,6 +131,12 @@ namespace casadi {
     /** \brief Get the operation */
     virtual int op() const { return OP_CALL;}
 
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    virtual bool is_equal(const MXNode* node, int depth) const {
+      return sameOpAndDeps(node, depth)
+        && static_cast<const Call*>(node)->fcn_.get()==fcn_.get();
+    }
+
     /** \brief Get required length of arg field */
     virtual size_t sz_arg() const;
 
@@ -24,6 +24,7 @@
 
 
 #include "concat.hpp"
+#include "getnonzeros.hpp"
 #include "../std_vector_tools.hpp"
 
 using namespace std;
@@ -117,6 +118,15 @@ namespace casadi {
     for (auto&& j : nz) {
       if (j>=0 && (j < begin || j >= end)) {
 
+        // Compose with the arguments if they are all taken from the same expression
+        MX src;
+        vector<int> nz_all;
+        if (GetNonzeros::gather(dep_, src, nz_all)) {
+          vector<int> nz_new(nz);
+          for (auto&& k : nz_new) if (k>=0) k = nz_all[k];
+          return src->getGetNonzeros(sp, nz_new);
+        }
+
         // Fallback to the base class
         return MXNode::getGetNonzeros(sp, nz);
       }
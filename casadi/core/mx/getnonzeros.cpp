@@ -465,6 +465,29 @@ namespace casadi {
     return dep()->getGetNonzeros(sp, nz_new);
   }
 
+  bool GetNonzeros::gather(const std::vector<MX>& x, MX& src, std::vector<int>& nz) {
+    nz.clear();
+    bool any_gather = false;
+    for (auto&& e : x) {
+      // Source expression and the nonzeros of it
+      bool is_gather = e.op()==OP_GETNONZEROS;
+      const MX& e_src = is_gather ? e->dep() : e;
+      if (&e==&x.front()) {
+        src = e_src;
+      } else if (!MX::is_equal(e_src, src)) {
+        return false;
+      }
+      if (is_gather) {
+        any_gather = true;
+        vector<int> nz_e = static_cast<const GetNonzeros*>(e.get())->all();
+        nz.insert(nz.end(), nz_e.begin(), nz_e.end());
+      } else {
+        for (int k=0; k<e.nnz(); ++k) nz.push_back(k);
+      }
+    }
+    return any_gather;
+  }
+
   void GetNonzerosSlice::generate(CodeGenerator& g, const std::string& mem,
                                   const std::vector<int>& arg, const std::vector<int>& res) const {
     g.body << "  for (rr=" << g.work(res[0], nnz()) << ", ss="
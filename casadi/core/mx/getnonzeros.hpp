@@ -68,6 +68,12 @@ namespace casadi {
 
     /// Get the nonzeros of matrix
     virtual MX getGetNonzeros(const Sparsity& sp, const std::vector<int>& nz) const;
+
+    /** \brief Write the concatenated nonzeros of x as a gather from a single expression
+     * Succeeds if every element of x is either a GetNonzeros node or the common source
+     * expression itself, and at least one of them is a GetNonzeros node.
+     */
+    static bool gather(const std::vector<MX>& x, MX& src, std::vector<int>& nz);
   };
 
   class CASADI_EXPORT GetNonzerosVector : public GetNonzeros {
@@ -125,6 +131,9 @@ namespace casadi {
     /// Get all the nonzeros
     virtual std::vector<int> all() const { return s_.all(s_.stop);}
 
+    /// Contiguous range of the nonzeros if unit step
+    virtual int view_offset(int oind) const { return s_.step==1 ? s_.start : -1;}
+
     /// Check if the instance is in fact an identity mapping (that can be simplified)
     bool is_identity() const;
 
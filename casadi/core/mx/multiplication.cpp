@@ -29,6 +29,7 @@
 #include "multiplication.hpp"
 #include "../std_vector_tools.hpp"
 #include "../function/function_internal.hpp"
+#include "../casadi_blas.hpp"
 
 using namespace std;
 
@@ -60,6 +61,8 @@ namespace casadi {
   template<typename T>
   void Multiplication::evalGen(const T** arg, T** res, int* iw, T* w, int mem) const {
     if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
+    if (casadi_blas_mtimes(arg[1], dep(1).sparsity(), arg[2], dep(2).sparsity(),
+                           res[0], sparsity())) return;
     casadi_mtimes(arg[1], dep(1).sparsity(),
                arg[2], dep(2).sparsity(),
                res[0], sparsity(), w, false);
@@ -117,13 +120,17 @@ namespace casadi {
   void DenseMultiplication::
   generate(CodeGenerator& g, const std::string& mem,
            const std::vector<int>& arg, const std::vector<int>& res) const {
+    int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
+
+    // Large products through BLAS
+    if (g.use_blas(nrow_x, ncol_y, nrow_y)) return Multiplication::generate(g, mem, arg, res);
+
     // Copy first argument if not inplace
     if (arg[0]!=res[0]) {
       g.body << "  " << g.copy(g.work(arg[0], nnz()), nnz(),
                                g.work(res[0], nnz())) << endl;
     }
 
-    int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
     g.body << "  for (i=0, rr=" << g.work(res[0], nnz()) <<"; i<" << ncol_y << "; ++i)";
     g.body << " for (j=0; j<" << nrow_x << "; ++j, ++rr)";
     g.body << " for (k=0, ss=" << g.work(arg[1], dep(1).nnz()) << "+j, tt="
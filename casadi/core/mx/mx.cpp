@@ -29,9 +29,13 @@
 #include "multiple_output.hpp"
 #include "../std_vector_tools.hpp"
 #include "norm.hpp"
+#include "solve.hpp"
+#include "shared_solve.hpp"
 #include "../calculus.hpp"
 #include "../function/mx_function.hpp"
 #include "../function/linsol.hpp"
+#include <unordered_map>
+#include <queue>
 
 using namespace std;
 namespace casadi {
@@ -580,6 +584,63 @@ namespace casadi {
     }
   }
 
+  /// Estimated number of multiply-adds in a sparse matrix product
+  static double mtimes_flops(const Sparsity& x, const Sparsity& y) {
+    casadi_assert(x.size2()==y.size1());
+
+    // Number of nonzeros in each row of y
+    vector<int> y_rowcount(y.size1(), 0);
+    const int* y_row = y.row();
+    for (int k=0; k<y.nnz(); ++k) y_rowcount[y_row[k]]++;
+
+    // Each nonzero in column k of x is multiplied with each nonzero in row k of y
+    const int* x_colind = x.colind();
+    double r = 0;
+    for (int k=0; k<x.size2(); ++k) {
+      r += static_cast<double>(x_colind[k+1]-x_colind[k]) * y_rowcount[k];
+    }
+    return r;
+  }
+
+  /// Product of the factors i to j, split as given
+  static MX mtimes_split(const vector<MX>& args, const vector<vector<int> >& split,
+                         int i, int j) {
+    if (i==j) return args[i];
+    int k = split[i][j];
+    return MX::mtimes(mtimes_split(args, split, i, k), mtimes_split(args, split, k+1, j));
+  }
+
+  /// Product of a chain of factors, with the parenthesization minimizing the estimated cost
+  static MX mtimes_chain(const vector<MX>& args) {
+    // Scalar factors are multiplied elementwise, use the left-to-right product
+    int n = args.size();
+    bool has_scalar = false;
+    for (auto&& a : args) has_scalar = has_scalar || a.is_scalar();
+    if (n<=2 || has_scalar) return MX::mtimes(args);
+
+    // Sparsity of the product of factors i to j, minimal cost and where to split
+    vector<vector<Sparsity> > sp(n, vector<Sparsity>(n));
+    vector<vector<double> > cost(n, vector<double>(n, 0));
+    vector<vector<int> > split(n, vector<int>(n, -1));
+    for (int i=0; i<n; ++i) sp[i][i] = args[i].sparsity();
+    for (int len=2; len<=n; ++len) {
+      for (int i=0; i+len<=n; ++i) {
+        int j = i+len-1;
+        sp[i][j] = Sparsity::mtimes(sp[i][j-1], sp[j][j]);
+        for (int k=i; k<j; ++k) {
+          double c = cost[i][k] + cost[k+1][j] + mtimes_flops(sp[i][k], sp[k+1][j]);
+          if (split[i][j]<0 || c<cost[i][j]) {
+            cost[i][j] = c;
+            split[i][j] = k;
+          }
+        }
+      }
+    }
+
+    // Form the product with the optimal parenthesization
+    return mtimes_split(args, split, 0, n-1);
+  }
+
   MX MX::mac(const MX& x, const MX& y, const MX& z) {
     if (x.is_scalar() || y.is_scalar()) {
       // Use element-wise multiplication if at least one factor scalar
@@ -1402,6 +1463,386 @@ namespace casadi {
 
   }
 
+  std::vector<MX> MX::cse(const std::vector<MX>& e) {
+    // Sort the expressions
+    Function f("tmp", vector<MX>{}, e);
+    auto *ff = dynamic_cast<MXFunction *>(f.get());
+
+    // Canonical expression for each element of the work vector
+    vector<MX> swork(ff->workloc_.size()-1);
+
+    // Unique nodes along with their outputs, bucketed by a hash of the operation,
+    // the dimensions and the (unordered) dependencies
+    struct UniqueNode {
+      MX node;
+      vector<MX> out;
+    };
+    unordered_map<size_t, vector<UniqueNode> > unique;
+
+    // Return value
+    vector<MX> ret(f.n_out());
+
+    // Pass through the algorithm
+    vector<MX> oarg, ores;
+    vector<const MXNode*> deps;
+    for (auto&& a : ff->algorithm_) {
+      switch (a.op) {
+      case OP_INPUT:
+      case OP_PARAMETER:
+        swork[a.res.front()] = a.data;
+        break;
+      case OP_OUTPUT:
+        ret[a.res.front()] = swork[a.arg.front()];
+        break;
+      default:
+        {
+          // Canonical arguments
+          bool changed = false;
+          oarg.resize(a.arg.size());
+          for (int i=0; i<oarg.size(); ++i) {
+            int el = a.arg[i];
+            oarg[i] = el<0 ? MX(a.data->dep(i).size()) : swork.at(el);
+            changed = changed || !is_equal(oarg[i], a.data->dep(i));
+          }
+
+          // Node with canonical arguments along with its outputs
+          MX node;
+          if (!changed) {
+            node = a.data;
+            ores.resize(a.res.size());
+            if (a.data->isMultipleOutput()) {
+              for (int i=0; i<ores.size(); ++i) ores[i] = a.data->getOutput(i);
+            } else {
+              ores[0] = a.data;
+            }
+          } else {
+            const_cast<MX&>(a.data)->eval_mx(oarg, ores);
+            if (!a.data->isMultipleOutput()) {
+              node = ores[0];
+            } else {
+              for (auto&& r : ores) {
+                if (r->isOutputNode()) {
+                  node = r->dep();
+                  break;
+                }
+              }
+            }
+          }
+
+          // Look for an equivalent node
+          if (!node.is_null()) {
+            deps.resize(node->ndep());
+            for (int i=0; i<deps.size(); ++i) deps[i] = node->dep(i).get();
+            sort(deps.begin(), deps.end());
+            size_t h = node.op();
+            hash_combine(h, node.size1());
+            hash_combine(h, node.size2());
+            hash_combine(h, node.nnz());
+            for (auto&& d : deps) hash_combine(h, reinterpret_cast<size_t>(d));
+            vector<UniqueNode>& bucket = unique[h];
+            bool found = false;
+            for (auto&& u : bucket) {
+              if (u.out.size()==ores.size() && MXNode::is_equal(u.node.get(), node.get(), 1)) {
+                ores = u.out;
+                found = true;
+                break;
+              }
+            }
+            if (!found) bucket.push_back(UniqueNode{node, ores});
+          }
+
+          // Store the results
+          for (int i=0; i<a.res.size(); ++i) {
+            if (a.res[i]>=0) swork[a.res[i]] = ores[i];
+          }
+        }
+      }
+    }
+    return ret;
+  }
+
+  MX MX::cse(const MX& e) {
+    return cse(vector<MX>{e}).front();
+  }
+
+  std::vector<MX> MX::reorder_mtimes(const std::vector<MX>& e) {
+    // Sort the expressions, one work vector element per node
+    Function f("tmp", vector<MX>{}, e, Dict{{"live_variables", false}});
+    auto *ff = dynamic_cast<MXFunction *>(f.get());
+    const vector<MXAlgEl>& algorithm = ff->algorithm_;
+    vector<MX> swork(ff->workloc_.size()-1);
+
+    // Number of references to each work vector element
+    vector<int> refcount(swork.size(), 0);
+    for (auto&& a : algorithm) {
+      for (auto&& i : a.arg) if (i>=0) refcount[i]++;
+    }
+
+    // Factors of products that are referenced only once and can be absorbed
+    map<const MXNode*, vector<MX> > chain;
+
+    // Return value
+    vector<MX> ret(f.n_out());
+
+    // Pass through the algorithm
+    vector<MX> oarg, ores, factors;
+    for (auto&& a : algorithm) {
+      switch (a.op) {
+      case OP_INPUT:
+      case OP_PARAMETER:
+        swork[a.res.front()] = a.data;
+        break;
+      case OP_OUTPUT:
+        ret[a.res.front()] = swork[a.arg.front()];
+        break;
+      default:
+        {
+          // Updated arguments
+          bool changed = false;
+          oarg.resize(a.arg.size());
+          for (int i=0; i<oarg.size(); ++i) {
+            int el = a.arg[i];
+            oarg[i] = el<0 ? MX(a.data->dep(i).size()) : swork.at(el);
+            changed = changed || !is_equal(oarg[i], a.data->dep(i));
+          }
+
+          // Product without accumulation
+          if (a.op==OP_MTIMES && oarg[0].is_zero()) {
+            // Collect the factors, absorbing single-use products
+            factors.clear();
+            for (int i=1; i<3; ++i) {
+              auto it = chain.find(oarg[i].get());
+              if (it==chain.end()) {
+                factors.push_back(oarg[i]);
+              } else {
+                factors.insert(factors.end(), it->second.begin(), it->second.end());
+              }
+            }
+
+            // Rebuild as a chain of products if there are more than two factors
+            MX r;
+            if (factors.size()>2) {
+              r = mtimes_chain(factors);
+            } else if (changed) {
+              r = mac(oarg[1], oarg[2], oarg[0]);
+            } else {
+              r = a.data;
+            }
+            if (refcount[a.res.front()]==1) chain[r.get()] = factors;
+            swork[a.res.front()] = r;
+            break;
+          }
+
+          // Other operations
+          ores.resize(a.res.size());
+          if (a.res.size()==1 && a.res[0]>=0 && !changed) {
+            ores[0] = a.data;
+          } else {
+            const_cast<MX&>(a.data)->eval_mx(oarg, ores);
+          }
+          for (int i=0; i<a.res.size(); ++i) {
+            if (a.res[i]>=0) swork[a.res[i]] = ores[i];
+          }
+        }
+      }
+    }
+    return ret;
+  }
+
+  MX MX::reorder_mtimes(const MX& e) {
+    return reorder_mtimes(vector<MX>{e}).front();
+  }
+
+  std::vector<MX> MX::merge_solves(const std::vector<MX>& e) {
+    // Sort the expressions, one work vector element per node
+    Function f("tmp", vector<MX>{}, e, Dict{{"live_variables", false}});
+    auto *ff = dynamic_cast<MXFunction *>(f.get());
+    const vector<MXAlgEl>& algorithm = ff->algorithm_;
+    int nalg = algorithm.size();
+    vector<MX> swork(ff->workloc_.size()-1);
+
+    // Algorithm element calculating each work vector element
+    vector<int> producer(swork.size(), -1);
+    for (int k=0; k<nalg; ++k) {
+      if (algorithm[k].op==OP_OUTPUT) continue;
+      for (auto&& i : algorithm[k].res) if (i>=0) producer[i] = k;
+    }
+
+    // Group the solves with the same matrix into batches. A solve can join the open
+    // batch of its matrix only if it does not depend on that batch or on any batch
+    // created after it, which keeps the merged graph acyclic.
+    vector<int> batch(nalg, -1), matrix(nalg, -1);
+    vector<int> dep_batch(swork.size(), -1);
+    vector<Linsol> batch_linsol;
+    vector<vector<int> > batch_el;
+    map<int, int> open_batch;
+    for (int k=0; k<nalg; ++k) {
+      const MXAlgEl& a = algorithm[k];
+      if (a.op==OP_INPUT || a.op==OP_PARAMETER || a.op==OP_OUTPUT) continue;
+
+      // Latest batch that the arguments depend on
+      int d = -1;
+      for (auto&& i : a.arg) if (i>=0) d = std::max(d, dep_batch[i]);
+
+      // Matrix and linear solver, if any
+      int A = -1;
+      const Linsol* linsol = 0;
+      if (a.op==OP_SOLVE) {
+        if (auto n = dynamic_cast<const Solve<false>*>(a.data.get())) {
+          A = a.arg[1];
+          linsol = &n->linsol_;
+        } else if (auto n = dynamic_cast<const Solve<true>*>(a.data.get())) {
+          A = a.arg[1];
+          linsol = &n->linsol_;
+        } else if (auto n = dynamic_cast<const SharedSolve*>(a.data.get())) {
+          // Solves merged before join the batch with all their right-hand-sides
+          A = a.arg[0];
+          linsol = &n->linsol_;
+        }
+      } else if (a.op==OP_INVERSE) {
+        A = a.arg[0];
+      }
+
+      // Add to a batch
+      matrix[k] = A;
+      if (A>=0) {
+        auto it = open_batch.find(A);
+        if (it!=open_batch.end() && d<it->second) {
+          batch[k] = it->second;
+        } else {
+          batch[k] = open_batch[A] = batch_el.size();
+          batch_el.push_back(vector<int>());
+          batch_linsol.push_back(Linsol());
+        }
+        batch_el[batch[k]].push_back(k);
+        if (linsol && batch_linsol[batch[k]].is_null()) batch_linsol[batch[k]] = *linsol;
+        d = batch[k];
+      }
+      for (auto&& i : a.res) if (i>=0) dep_batch[i] = d;
+    }
+
+    // Only merge batches with more than one member and a linear solver
+    for (int b=0; b<batch_el.size(); ++b) {
+      if (batch_el[b].size()<2 || batch_linsol[b].is_null()) {
+        for (auto&& k : batch_el[b]) batch[k] = -1;
+        batch_el[b].clear();
+      }
+    }
+
+    // Dependency graph between units: algorithm elements and merged batches
+    int nunit = nalg + batch_el.size();
+    vector<vector<int> > succ(nunit);
+    vector<int> indeg(nunit, 0);
+    for (int k=0; k<nalg; ++k) {
+      const MXAlgEl& a = algorithm[k];
+      if (a.op==OP_INPUT || a.op==OP_PARAMETER) continue;
+      int u = batch[k]>=0 ? nalg + batch[k] : k;
+      for (auto&& i : a.arg) {
+        if (i<0) continue;
+        int p = producer[i];
+        int pu = batch[p]>=0 ? nalg + batch[p] : p;
+        if (pu==u) continue;
+        succ[pu].push_back(u);
+        indeg[u]++;
+      }
+    }
+
+    // Units without dependencies, in the original order
+    typedef pair<int, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry> > q;
+    for (int k=0; k<nalg; ++k) {
+      if (batch[k]<0 && indeg[k]==0) q.push(Entry(k, k));
+    }
+    for (int b=0; b<batch_el.size(); ++b) {
+      if (!batch_el[b].empty() && indeg[nalg+b]==0) q.push(Entry(batch_el[b].front(), nalg+b));
+    }
+
+    // Return value
+    vector<MX> ret(f.n_out());
+
+    // Rebuild the graph in topological order
+    vector<MX> oarg, ores;
+    vector<bool> tr;
+    while (!q.empty()) {
+      int u = q.top().second;
+      q.pop();
+      if (u>=nalg) {
+        // Merged linear solves
+        const vector<int>& el = batch_el[u-nalg];
+        oarg.clear();
+        tr.clear();
+        for (auto&& k : el) {
+          const MXAlgEl& a = algorithm[k];
+          if (auto n = dynamic_cast<const SharedSolve*>(a.data.get())) {
+            for (int i=0; i<n->nout(); ++i) {
+              oarg.push_back(a.arg[1+i]<0 ? MX(n->dep(1+i).size()) : swork.at(a.arg[1+i]));
+              tr.push_back(n->tr_[i]);
+            }
+          } else if (a.op==OP_SOLVE) {
+            oarg.push_back(a.arg[0]<0 ? MX(a.data->dep(0).size()) : swork.at(a.arg[0]));
+            tr.push_back(dynamic_cast<const Solve<true>*>(a.data.get())!=0);
+          } else {
+            oarg.push_back(MX::eye(a.data.size1()));
+            tr.push_back(false);
+          }
+        }
+        ores = SharedSolve::create(swork.at(matrix[el.front()]), oarg, tr, batch_linsol[u-nalg]);
+        int i=0;
+        for (auto&& k : el) {
+          for (auto&& r : algorithm[k].res) {
+            if (r>=0) swork[r] = ores[i];
+            i++;
+          }
+        }
+      } else {
+        const MXAlgEl& a = algorithm[u];
+        switch (a.op) {
+        case OP_INPUT:
+        case OP_PARAMETER:
+          swork[a.res.front()] = a.data;
+          break;
+        case OP_OUTPUT:
+          ret[a.res.front()] = swork[a.arg.front()];
+          break;
+        default:
+          {
+            // Updated arguments
+            bool changed = false;
+            oarg.resize(a.arg.size());
+            for (int i=0; i<oarg.size(); ++i) {
+              int el = a.arg[i];
+              oarg[i] = el<0 ? MX(a.data->dep(i).size()) : swork.at(el);
+              changed = changed || !is_equal(oarg[i], a.data->dep(i));
+            }
+
+            // Rebuild if needed
+            ores.resize(a.res.size());
+            if (a.res.size()==1 && a.res[0]>=0 && !changed) {
+              ores[0] = a.data;
+            } else {
+              const_cast<MX&>(a.data)->eval_mx(oarg, ores);
+            }
+            for (int i=0; i<a.res.size(); ++i) {
+              if (a.res[i]>=0) swork[a.res[i]] = ores[i];
+            }
+          }
+        }
+      }
+
+      // Release the units depending on this one
+      for (auto&& s : succ[u]) {
+        if (--indeg[s]==0) {
+          q.push(Entry(s<nalg ? s : batch_el[s-nalg].front(), s));
+        }
+      }
+    }
+    return ret;
+  }
+
+  MX MX::merge_solves(const MX& e) {
+    return merge_solves(vector<MX>{e}).front();
+  }
+
   void MX::shared(std::vector<MX>& ex, std::vector<MX>& v, std::vector<MX>& vdef,
                          const std::string& v_prefix, const std::string& v_suffix) {
 
@@ -462,6 +462,12 @@ namespace casadi {
                                          const std::vector<MX>& boundary,
                                          const Dict& options);
     static MX lift(const MX& x, const MX& x_guess);
+    static MX cse(const MX& e);
+    static std::vector<MX> cse(const std::vector<MX>& e);
+    static MX reorder_mtimes(const MX& e);
+    static std::vector<MX> reorder_mtimes(const std::vector<MX>& e);
+    static MX merge_solves(const MX& e);
+    static std::vector<MX> merge_solves(const std::vector<MX>& e);
     ///@}
     /// \endcond
 
@@ -532,6 +538,49 @@ namespace casadi {
     inline friend MX lift(const MX& x, const MX& x_guess) {
       return MX::lift(x, x_guess);
     }
+
+    ///@{
+    /** \brief Common subexpression elimination
+     *  Merges nodes with the same operation, the same dependencies and the same
+     *  node-specific data, e.g. calls to the same Function or solves with the
+     *  same linear solver.
+     */
+    inline friend MX cse(const MX& e) {
+      return MX::cse(e);
+    }
+    inline friend std::vector<MX> cse(const std::vector<MX>& e) {
+      return MX::cse(e);
+    }
+    ///@}
+
+    ///@{
+    /** \brief Reorder chains of matrix products
+     *  Products of three or more factors, where the intermediate products are not used
+     *  elsewhere, are rebuilt with the parenthesization that minimizes the number of
+     *  multiply-adds estimated from the sparsity patterns.
+     */
+    inline friend MX reorder_mtimes(const MX& e) {
+      return MX::reorder_mtimes(e);
+    }
+    inline friend std::vector<MX> reorder_mtimes(const std::vector<MX>& e) {
+      return MX::reorder_mtimes(e);
+    }
+    ///@}
+
+    ///@{
+    /** \brief Share factorizations between linear solves
+     *  Linear solves and inverses with the same matrix node, transposed or not, are
+     *  merged into a single node that factorizes the matrix once. Solves that depend
+     *  on each other are kept apart. Identical matrix expressions must be the same
+     *  node, see cse.
+     */
+    inline friend MX merge_solves(const MX& e) {
+      return MX::merge_solves(e);
+    }
+    inline friend std::vector<MX> merge_solves(const std::vector<MX>& e) {
+      return MX::merge_solves(e);
+    }
+    ///@}
 /** @} */
 #endif // SWIG
 
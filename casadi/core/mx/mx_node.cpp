@@ -483,6 +483,15 @@ namespace casadi {
       return y;
     }
 
+    // Gather instead if y is zero or all its nonzeros get overwritten
+    vector<int> nz_inv(y.nnz(), -1);
+    for (int k=0; k<nz.size(); ++k) if (nz[k]>=0) nz_inv[nz[k]] = k;
+    bool overwrite = true;
+    for (auto&& k : nz_inv) overwrite = overwrite && k>=0;
+    if (overwrite || y.is_zero()) {
+      return getGetNonzeros(y.sparsity(), nz_inv);
+    }
+
     // Check if slice
     MX ret;
     if (is_slice(nz)) {
@@ -802,6 +811,15 @@ namespace casadi {
       }
     }
 
+    // Gather directly if all arguments are taken from the same expression
+    MX src;
+    vector<int> nz;
+    if (GetNonzeros::gather(x, src, nz)) {
+      vector<Sparsity> sp(x.size());
+      for (int i=0; i<x.size(); ++i) sp[i] = x[i].sparsity();
+      return src->getGetNonzeros(Sparsity::horzcat(sp), nz);
+    }
+
     // Create a Horzcat node
     return MX::create(new Horzcat(x));
   }
@@ -828,6 +846,15 @@ namespace casadi {
       }
     }
 
+    // Gather directly if all arguments are taken from the same expression
+    MX src;
+    vector<int> nz;
+    if (GetNonzeros::gather(x, src, nz)) {
+      vector<Sparsity> sp(x.size());
+      for (int i=0; i<x.size(); ++i) sp[i] = x[i].sparsity();
+      return src->getGetNonzeros(Sparsity::vertcat(sp), nz);
+    }
+
     return MX::create(new Vertcat(x));
   }
 
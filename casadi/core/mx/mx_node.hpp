@@ -309,6 +309,12 @@ namespace casadi {
     /// Can the operation be performed inplace (i.e. overwrite the result)
     virtual int numInplace() const { return 0;}
 
+    /** \brief Offset of output oind into the nonzeros of the first argument
+     * If non-negative, the output is a contiguous range of the nonzeros of the first
+     * argument and can share storage with it. -1 otherwise.
+     */
+    virtual int view_offset(int oind) const { return -1;}
+
     /// Simplify the expression (ex is a reference to the node)
     virtual void simplifyMe(MX& ex) {}
 
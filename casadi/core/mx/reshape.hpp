@@ -86,9 +86,17 @@ namespace casadi {
     /// Can the operation be performed inplace (i.e. overwrite the result)
     virtual int numInplace() const { return 1;}
 
+    /// The nonzeros are unchanged
+    virtual int view_offset(int oind) const { return 0;}
+
     /// Reshape
     virtual MX getReshape(const Sparsity& sp) const;
 
+    /// Get the nonzeros of matrix
+    virtual MX getGetNonzeros(const Sparsity& sp, const std::vector<int>& nz) const {
+      return dep()->getGetNonzeros(sp, nz);
+    }
+
     /** \brief Check if two nodes are equivalent up to a given depth */
     virtual bool is_equal(const MXNode* node, int depth) const
     { return sameOpAndDeps(node, depth) && sparsity()==node->sparsity();}
@@ -0,0 +1,296 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "shared_solve.hpp"
+#include "../function/linsol_internal.hpp"
+
+using namespace std;
+
+namespace casadi {
+
+  SharedSolve::SharedSolve(const MX& A, const std::vector<MX>& r, const std::vector<bool>& tr,
+                           const Linsol& linear_solver) : tr_(tr), linsol_(linear_solver) {
+    casadi_assert_message(r.size()==tr.size(), "SharedSolve::SharedSolve: dimension mismatch.");
+    vector<MX> dep(1, A);
+    for (auto&& ri : r) {
+      casadi_assert_message(ri.size1() == A.size2(),
+                            "SharedSolve::SharedSolve: dimension mismatch.");
+      dep.push_back(densify(ri));
+    }
+    setDependencies(dep);
+    setSparsity(Sparsity::scalar());
+  }
+
+  std::vector<MX> SharedSolve::create(const MX& A, const std::vector<MX>& r,
+                                      const std::vector<bool>& tr, const Linsol& linear_solver) {
+    return MX::createMultipleOutput(new SharedSolve(A, r, tr, linear_solver));
+  }
+
+  std::string SharedSolve::print(const std::vector<std::string>& arg) const {
+    std::stringstream ss;
+    ss << "(";
+    for (int i=0; i<tr_.size(); ++i) {
+      if (i>0) ss << ", ";
+      ss << arg.at(0);
+      if (tr_[i]) ss << "'";
+      ss << "\\" << arg.at(1+i);
+    }
+    ss << ")";
+    return ss.str();
+  }
+
+  void SharedSolve::eval(const double** arg, double** res, int* iw, double* w, int mem) const {
+    // Copy right-hand-sides to the outputs before any of them is overwritten
+    for (int i=0; i<tr_.size(); ++i) {
+      if (res[i] && arg[1+i]!=res[i]) copy(arg[1+i], arg[1+i]+dep(1+i).nnz(), res[i]);
+    }
+
+    // Factorize once
+    ScopedCheckout m(linsol_.operator->());
+    linsol_.reset(dep(0).sparsity(), m);
+    linsol_.pivoting(arg[0], m);
+    linsol_.factorize(arg[0], m);
+
+    // Solve for all right-hand-sides
+    for (int i=0; i<tr_.size(); ++i) {
+      if (res[i]) linsol_.solve(res[i], dep(1+i).size2(), tr_[i], m);
+    }
+  }
+
+  void SharedSolve::eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem) {
+    linsol_.reset(dep(0).sparsity());
+    for (int i=0; i<tr_.size(); ++i) {
+      if (!res[i]) continue;
+      const SXElem* arg1[] = {arg[1+i], arg[0]};
+      SXElem* res1[] = {res[i]};
+      linsol_->linsol_eval_sx(arg1, res1, iw, w, mem, tr_[i], dep(1+i).size2());
+    }
+  }
+
+  void SharedSolve::eval_mx(const std::vector<MX>& arg, std::vector<MX>& res) {
+    res = create(arg[0], vector<MX>(arg.begin()+1, arg.end()), tr_, linsol_);
+  }
+
+  void SharedSolve::evalFwd(const std::vector<std::vector<MX> >& fseed,
+                            std::vector<std::vector<MX> >& fsens) {
+    int nfwd = fseed.size();
+    int n = tr_.size();
+    const MX& A = dep(0);
+
+    // Right-hand-sides for all outputs and directions
+    vector<MX> rhs;
+    vector<bool> tr;
+    for (int d=0; d<nfwd; ++d) {
+      const MX& A_hat = fseed[d][0];
+      for (int i=0; i<n; ++i) {
+        MX X = getOutput(i);
+        const MX& B_hat = fseed[d][1+i];
+        rhs.push_back(tr_[i] ? B_hat - mtimes(A_hat.T(), X) : B_hat - mtimes(A_hat, X));
+        tr.push_back(tr_[i]);
+      }
+    }
+
+    // Solve with the same factorization
+    rhs = create(A, rhs, tr, linsol_);
+
+    // Fetch result
+    fsens.resize(nfwd);
+    for (int d=0; d<nfwd; ++d) {
+      fsens[d].assign(rhs.begin() + d*n, rhs.begin() + (d+1)*n);
+    }
+  }
+
+  void SharedSolve::evalAdj(const std::vector<std::vector<MX> >& aseed,
+                            std::vector<std::vector<MX> >& asens) {
+    int nadj = aseed.size();
+    int n = tr_.size();
+    const MX& A = dep(0);
+
+    // Transposed solves for all outputs and directions
+    vector<MX> rhs;
+    vector<bool> tr;
+    for (int d=0; d<nadj; ++d) {
+      for (int i=0; i<n; ++i) {
+        rhs.push_back(aseed[d][i]);
+        tr.push_back(!tr_[i]);
+      }
+    }
+    rhs = create(A, rhs, tr, linsol_);
+
+    // Collect sensitivities
+    asens.resize(nadj);
+    for (int d=0; d<nadj; ++d) {
+      asens[d].resize(1+n);
+      for (int i=0; i<n; ++i) {
+        const MX& r = rhs[d*n + i];
+        MX X = getOutput(i);
+
+        // Propagate to A
+        MX a;
+        if (!tr_[i]) {
+          a = -mac(r, X.T(), MX::zeros(A.sparsity()));
+        } else {
+          a = -mac(X, r.T(), MX::zeros(A.sparsity()));
+        }
+        if (asens[d][0].is_empty(true)) {
+          asens[d][0] = a;
+        } else {
+          asens[d][0] += a;
+        }
+
+        // Propagate to B
+        if (asens[d][1+i].is_empty(true)) {
+          asens[d][1+i] = r;
+        } else {
+          asens[d][1+i] += r;
+        }
+      }
+    }
+  }
+
+  void SharedSolve::addDependency(CodeGenerator& g) const {
+    linsol_->codegen_declarations(g, dep(0).sparsity());
+  }
+
+  void SharedSolve::generate(CodeGenerator& g, const std::string& mem,
+                             const std::vector<int>& arg, const std::vector<int>& res) const {
+    // Copy right-hand-sides to the outputs before any of them is overwritten
+    vector<string> x;
+    vector<int> nrhs;
+    for (int i=0; i<tr_.size(); ++i) {
+      int nnz = dep(1+i).nnz();
+      if (res[i]>=0 && arg[1+i]!=res[i]) {
+        g.body << "  " << g.copy(g.work(arg[1+i], nnz), nnz, g.work(res[i], nnz)) << endl;
+      }
+      x.push_back(g.work(res[i], nnz));
+      nrhs.push_back(res[i]>=0 ? dep(1+i).size2() : 0);
+    }
+
+    // Factorize once, solve for all right-hand-sides
+    linsol_->codegen_solve(g, dep(0).sparsity(), g.work(arg[0], dep(0).nnz()), x, nrhs, tr_);
+  }
+
+  void SharedSolve::sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    // Sparsities
+    const Sparsity& A_sp = dep(0).sparsity();
+    const int* A_colind = A_sp.colind();
+    const int* A_row = A_sp.row();
+    int n = A_sp.size1();
+    const bvec_t* A = arg[0];
+    bvec_t* tmp = w;
+
+    for (int i=0; i<tr_.size(); ++i) {
+      const bvec_t* B = arg[1+i];
+      bvec_t* X = res[i];
+      if (!X) continue;
+
+      // For all right-hand-sides
+      for (int r=0; r<dep(1+i).size2(); ++r) {
+        // Copy B to a temporary vector
+        copy(B, B+n, tmp);
+
+        // Add A_hat contribution to tmp
+        for (int cc=0; cc<n; ++cc) {
+          for (int k=A_colind[cc]; k<A_colind[cc+1]; ++k) {
+            int rr = A_row[k];
+            tmp[tr_[i] ? cc : rr] |= A[k];
+          }
+        }
+
+        // Propagate to X
+        std::fill(X, X+n, 0);
+        A_sp.spsolve(X, tmp, tr_[i]);
+
+        // Continue to the next right-hand-side
+        B += n;
+        X += n;
+      }
+    }
+  }
+
+  void SharedSolve::sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
+    // Sparsities
+    const Sparsity& A_sp = dep(0).sparsity();
+    const int* A_colind = A_sp.colind();
+    const int* A_row = A_sp.row();
+    int n = A_sp.size1();
+    bvec_t* A = arg[0];
+    bvec_t* tmp = w;
+
+    for (int i=0; i<tr_.size(); ++i) {
+      bvec_t* B = arg[1+i];
+      bvec_t* X = res[i];
+      if (!X) continue;
+
+      // For all right-hand-sides
+      for (int r=0; r<dep(1+i).size2(); ++r) {
+        // Solve transposed
+        std::fill(tmp, tmp+n, 0);
+        A_sp.spsolve(tmp, X, !tr_[i]);
+
+        // Clear seeds
+        std::fill(X, X+n, 0);
+
+        // Propagate to B
+        for (int j=0; j<n; ++j) B[j] |= tmp[j];
+
+        // Propagate to A
+        for (int cc=0; cc<n; ++cc) {
+          for (int k=A_colind[cc]; k<A_colind[cc+1]; ++k) {
+            int rr = A_row[k];
+            A[k] |= tmp[tr_[i] ? cc : rr];
+          }
+        }
+
+        // Continue to the next right-hand-side
+        B += n;
+        X += n;
+      }
+    }
+  }
+
+  bool SharedSolve::is_equal(const MXNode* node, int depth) const {
+    const SharedSolve* n = dynamic_cast<const SharedSolve*>(node);
+    return n && sameOpAndDeps(node, depth) && n->tr_==tr_
+      && linsol_->is_equivalent(*n->linsol_.operator->());
+  }
+
+  size_t SharedSolve::sz_arg() const {
+    return ndep() + linsol_->sz_arg();
+  }
+
+  size_t SharedSolve::sz_res() const {
+    return nout() + linsol_->sz_res();
+  }
+
+  size_t SharedSolve::sz_iw() const {
+    return linsol_->sz_iw();
+  }
+
+  size_t SharedSolve::sz_w() const {
+    return linsol_->sz_w() + dep(0).size1();
+  }
+
+} // namespace casadi
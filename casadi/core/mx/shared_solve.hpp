@@ -0,0 +1,122 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SHARED_SOLVE_HPP
+#define CASADI_SHARED_SOLVE_HPP
+
+#include "multiple_output.hpp"
+#include "../function/linsol.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+  /** \brief Several linear solves with the same matrix: x_i = A^-1 r_i or x_i = A^-T r_i
+
+      The matrix is factorized once per evaluation and the factorization is
+      used for all right-hand-sides, transposed or not. Created by MX::merge_solves.
+  */
+  class CASADI_EXPORT SharedSolve : public MultipleOutput {
+  public:
+
+    /** \brief  Constructor */
+    SharedSolve(const MX& A, const std::vector<MX>& r, const std::vector<bool>& tr,
+                const Linsol& linear_solver);
+
+    /** \brief  Create the node and return its outputs */
+    static std::vector<MX> create(const MX& A, const std::vector<MX>& r,
+                                  const std::vector<bool>& tr, const Linsol& linear_solver);
+
+    /** \brief  Destructor */
+    virtual ~SharedSolve() {}
+
+    /** \brief  Number of outputs */
+    virtual int nout() const { return tr_.size();}
+
+    /** \brief  Get the sparsity of output oind */
+    virtual const Sparsity& sparsity(int oind) const { return dep(1+oind).sparsity();}
+
+    /** \brief  Print expression */
+    virtual std::string print(const std::vector<std::string>& arg) const;
+
+    /// Evaluate the function numerically
+    virtual void eval(const double** arg, double** res, int* iw, double* w, int mem) const;
+
+    /// Evaluate the function symbolically (SX)
+    virtual void eval_sx(const SXElem** arg, SXElem** res, int* iw, SXElem* w, int mem);
+
+    /** \brief  Evaluate symbolically (MX) */
+    virtual void eval_mx(const std::vector<MX>& arg, std::vector<MX>& res);
+
+    /** \brief Calculate forward mode directional derivatives */
+    virtual void evalFwd(const std::vector<std::vector<MX> >& fseed,
+                         std::vector<std::vector<MX> >& fsens);
+
+    /** \brief Calculate reverse mode directional derivatives */
+    virtual void evalAdj(const std::vector<std::vector<MX> >& aseed,
+                         std::vector<std::vector<MX> >& asens);
+
+    /** \brief Add the QR functions used in generated code */
+    virtual void addDependency(CodeGenerator& g) const;
+
+    /** \brief Generate code for the operation */
+    virtual void generate(CodeGenerator& g, const std::string& mem,
+                          const std::vector<int>& arg, const std::vector<int>& res) const;
+
+    /** \brief  Propagate sparsity forward */
+    virtual void sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+    /** \brief  Propagate sparsity backwards */
+    virtual void sp_rev(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
+
+    /** \brief Get the operation */
+    virtual int op() const { return OP_SOLVE;}
+
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    virtual bool is_equal(const MXNode* node, int depth) const;
+
+    /** \brief Get required length of arg field */
+    virtual size_t sz_arg() const;
+
+    /** \brief Get required length of res field */
+    virtual size_t sz_res() const;
+
+    /** \brief Get required length of iw field */
+    virtual size_t sz_iw() const;
+
+    /** \brief Get required length of w field */
+    virtual size_t sz_w() const;
+
+    /// Transpose the matrix for each right-hand-side
+    std::vector<bool> tr_;
+
+    /// Linear Solver (may be shared between multiple nodes)
+    Linsol linsol_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_SHARED_SOLVE_HPP
@@ -72,6 +72,13 @@ namespace casadi {
     virtual void evalAdj(const std::vector<std::vector<MX> >& aseed,
                          std::vector<std::vector<MX> >& asens);
 
+    /** \brief Add the QR functions used in generated code */
+    virtual void addDependency(CodeGenerator& g) const;
+
+    /** \brief Generate code for the operation */
+    virtual void generate(CodeGenerator& g, const std::string& mem,
+                          const std::vector<int>& arg, const std::vector<int>& res) const;
+
     /** \brief  Propagate sparsity forward */
     virtual void sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem);
 
@@ -81,6 +88,9 @@ namespace casadi {
     /** \brief Get the operation */
     virtual int op() const { return OP_SOLVE;}
 
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    virtual bool is_equal(const MXNode* node, int depth) const;
+
     /// Can the operation be performed inplace (i.e. overwrite the result)
     virtual int numInplace() const { return 1;}
 
@@ -53,10 +53,11 @@ namespace casadi {
   template<bool Tr>
   void Solve<Tr>::eval(const double** arg, double** res, int* iw, double* w, int mem) const {
     if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
-    linsol_.reset(dep(1).sparsity());
-    linsol_.pivoting(arg[1]);
-    linsol_.factorize(arg[1]);
-    linsol_.solve(res[0], dep(0).size2(), Tr);
+    ScopedCheckout m(linsol_.operator->());
+    linsol_.reset(dep(1).sparsity(), m);
+    linsol_.pivoting(arg[1], m);
+    linsol_.factorize(arg[1], m);
+    linsol_.solve(res[0], dep(0).size2(), Tr, m);
   }
 
   template<bool Tr>
@@ -157,6 +158,23 @@ namespace casadi {
     }
   }
 
+  template<bool Tr>
+  void Solve<Tr>::addDependency(CodeGenerator& g) const {
+    linsol_->codegen_declarations(g, dep(1).sparsity());
+  }
+
+  template<bool Tr>
+  void Solve<Tr>::generate(CodeGenerator& g, const std::string& mem,
+                           const std::vector<int>& arg, const std::vector<int>& res) const {
+    // Solve in place
+    int nnz = dep(0).nnz();
+    if (arg[0]!=res[0]) {
+      g.body << "  " << g.copy(g.work(arg[0], nnz), nnz, g.work(res[0], nnz)) << endl;
+    }
+    linsol_->codegen_solve(g, dep(1).sparsity(), g.work(arg[1], dep(1).nnz()),
+                           {g.work(res[0], nnz)}, {dep(0).size2()}, {Tr});
+  }
+
   template<bool Tr>
   void Solve<Tr>::sp_fwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w, int mem) {
     // Number of right-hand-sides
@@ -237,6 +255,14 @@ namespace casadi {
     }
   }
 
+  template<bool Tr>
+  bool Solve<Tr>::is_equal(const MXNode* node, int depth) const {
+    // Linear solvers created independently are interchangeable if created alike,
+    // the sparsity is that of the matrix argument
+    const Solve<Tr>* n = dynamic_cast<const Solve<Tr>*>(node);
+    return n && sameOpAndDeps(node, depth) && linsol_->is_equivalent(*n->linsol_.operator->());
+  }
+
   template<bool Tr>
   size_t Solve<Tr>::sz_arg() const {
     return ndep() + linsol_->sz_arg();
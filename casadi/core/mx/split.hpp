@@ -52,6 +52,9 @@ namespace casadi {
     /** \brief  Get the sparsity of output oind */
     virtual const Sparsity& sparsity(int oind) const { return output_sparsity_.at(oind);}
 
+    /// Each output is a contiguous range of the nonzeros
+    virtual int view_offset(int oind) const { return offset_.at(oind);}
+
     /// Evaluate the function (template)
     template<typename T>
     void evalGen(const T** arg, T** res, int* iw, T* w, int mem) const;
@@ -194,4 +194,15 @@ namespace casadi {
            << "rr[i+j*" << dep().size2() << "] = *cs++;" << endl;
   }
 
+  MX Transpose::getGetNonzeros(const Sparsity& sp, const std::vector<int>& nz) const {
+    // Nonzeros of the argument for each nonzero of the transpose
+    vector<int> mapping;
+    dep().sparsity().transpose(mapping);
+
+    // Compose the mappings
+    vector<int> nz_new(nz);
+    for (auto&& i : nz_new) if (i>=0) i = mapping[i];
+    return dep()->getGetNonzeros(sp, nz_new);
+  }
+
 } // namespace casadi
@@ -83,12 +83,18 @@ namespace casadi {
     /** \brief Get the operation */
     virtual int op() const { return OP_TRANSPOSE;}
 
+    /// The nonzeros are unchanged for vectors
+    virtual int view_offset(int oind) const { return dep().is_vector() ? 0 : -1;}
+
     /** \brief Get required length of iw field */
     virtual size_t sz_iw() const { return size2()+1;}
 
     /// Transpose
     virtual MX getTranspose() const { return dep();}
 
+    /// Get the nonzeros of matrix
+    virtual MX getGetNonzeros(const Sparsity& sp, const std::vector<int>& nz) const;
+
     /// Solve for square linear system
     //virtual MX getSolve(const MX& r, bool tr, const Linsol& linear_solver) const {
     // return dep()->getSolve(r, !tr, linear_solver);} // FIXME #1001
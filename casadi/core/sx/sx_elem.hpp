@@ -253,6 +253,43 @@ namespace casadi {
 #endif // SWIG
 /// \endcond
 
+  /// \cond INTERNAL
+  class SXNodePool;
+  /// \endcond
+
+  /** \brief Scoped arena for SX expression nodes
+
+      While an instance is alive, all new SX nodes are allocated from memory owned
+      by the arena rather than from the shared node pool. The memory is released
+      in one go once the arena has gone out of scope and all nodes created
+      in it have been destroyed. Arenas can be nested, but must be destroyed in
+      the reverse order of creation. The arena only affects the thread that created it.
+  */
+  class CASADI_EXPORT SXArena {
+  public:
+    /// Start allocating SX nodes from a new arena
+    SXArena();
+
+    /// Stop allocating from the arena
+    ~SXArena();
+
+    /// Number of nodes currently allocated in the arena
+    size_t n_nodes() const;
+
+    /// Number of arenas whose memory has not yet been released
+    static size_t n_pools();
+
+#ifndef SWIG
+  private:
+    /// Not copyable
+    SXArena(const SXArena&);
+    SXArena& operator=(const SXArena&);
+
+    // Memory pool of the arena and the one active before
+    SXNodePool *pool_, *prev_;
+#endif // SWIG
+  };
+
   ///@{
   /// Readability typedefs
   typedef Matrix<SXElem> SX;
@@ -26,6 +26,12 @@
 #include "sx_node.hpp"
 #include <limits>
 #include <typeinfo>
+#include <cstdlib>
+#include <stdint.h>
+#include <atomic>
+#ifdef _WIN32
+#include <malloc.h>
+#endif // _WIN32
 
 using namespace std;
 namespace casadi {
@@ -44,6 +50,151 @@ namespace casadi {
     }
   }
 
+  void* SXNode::operator new(std::size_t sz) {
+    return SXNodePool::active()->allocate(sz);
+  }
+
+  void SXNode::operator delete(void* ptr, std::size_t sz) {
+    SXNodePool::deallocate(ptr, sz);
+  }
+
+  namespace {
+    // Arena pool active in the current thread, if any
+    thread_local SXNodePool* active_pool = 0;
+
+    // Number of arena pools not yet deleted
+    std::atomic<size_t> n_arena_pools(0);
+  } // namespace
+
+  SXNodePool* SXNodePool::active() {
+    return active_pool ? active_pool : shared();
+  }
+
+  void SXNodePool::set_active(SXNodePool* pool) {
+    active_pool = pool;
+  }
+
+  SXNodePool* SXNodePool::shared() {
+    // Never destroyed, since static SXElem instances may outlive it otherwise
+    static SXNodePool* pool = new SXNodePool();
+    return pool;
+  }
+
+  SXNodePool::SXNodePool() : slabs_(0), n_alloc_(0), released_(false) {
+    for (size_t c=0; c<n_class; ++c) free_[c] = 0;
+  }
+
+  SXNodePool::~SXNodePool() {
+    while (slabs_) {
+      Slab* s = slabs_;
+      slabs_ = s->next;
+#ifdef _WIN32
+      _aligned_free(s);
+#else // _WIN32
+      free(s);
+#endif // _WIN32
+    }
+  }
+
+  void SXNodePool::grow(size_t c) {
+    // Allocate a slab, aligned so that its header can be found from any node in it
+    void* mem = 0;
+#ifdef _WIN32
+    mem = _aligned_malloc(slab_size, slab_size);
+#else // _WIN32
+    if (posix_memalign(&mem, slab_size, slab_size)) mem = 0;
+#endif // _WIN32
+    if (mem==0) throw std::bad_alloc();
+
+    // Initialize header
+    Slab* s = static_cast<Slab*>(mem);
+    s->pool = this;
+    s->next = slabs_;
+    slabs_ = s;
+
+    // Cut the remainder into blocks and add them to the free list
+    size_t block_size = (c+1)*granularity;
+    size_t header_size = granularity*((sizeof(Slab)+granularity-1)/granularity);
+    char* first = static_cast<char*>(mem) + header_size;
+    for (size_t k=(slab_size-header_size)/block_size; k-->0; ) {
+      void* b = first + k*block_size;
+      *static_cast<void**>(b) = free_[c];
+      free_[c] = b;
+    }
+  }
+
+  void* SXNodePool::allocate(size_t sz) {
+    size_t c = (sz+granularity-1)/granularity - 1;
+    if (c>=n_class) return ::operator new(sz);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (free_[c]==0) grow(c);
+    void* ret = free_[c];
+    free_[c] = *static_cast<void**>(ret);
+    n_alloc_++;
+    return ret;
+  }
+
+  void SXNodePool::deallocate(void* ptr, size_t sz) {
+    if (ptr==0) return;
+    size_t c = (sz+granularity-1)/granularity - 1;
+    if (c>=n_class) return ::operator delete(ptr);
+
+    // Find the pool from the slab header
+    uintptr_t s = reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(slab_size-1);
+    SXNodePool* pool = reinterpret_cast<Slab*>(s)->pool;
+
+    // Push to the free list
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(pool->mtx_);
+      *static_cast<void**>(ptr) = pool->free_[c];
+      pool->free_[c] = ptr;
+      last = --pool->n_alloc_==0 && pool->released_;
+    }
+
+    // The pool can no longer be reached by other threads
+    if (last) {
+      delete pool;
+      n_arena_pools--;
+    }
+  }
+
+  size_t SXNodePool::n_alloc() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return n_alloc_;
+  }
+
+  void SXNodePool::release() {
+    bool empty;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      released_ = true;
+      empty = n_alloc_==0;
+    }
+    if (empty) {
+      delete this;
+      n_arena_pools--;
+    }
+  }
+
+  SXArena::SXArena() : pool_(new SXNodePool()), prev_(SXNodePool::active()) {
+    n_arena_pools++;
+    SXNodePool::set_active(pool_);
+  }
+
+  SXArena::~SXArena() {
+    SXNodePool::set_active(prev_==SXNodePool::shared() ? 0 : prev_);
+    pool_->release();
+  }
+
+  size_t SXArena::n_nodes() const {
+    return pool_->n_alloc();
+  }
+
+  size_t SXArena::n_pools() {
+    return n_arena_pools;
+  }
+
   double SXNode::to_double() const {
     return numeric_limits<double>::quiet_NaN();
     /*  userOut<true, PL_WARN>() << "to_double() not defined for class " << typeid(*this).name() << std::endl;
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <mutex>
 #include <math.h>
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class) */
@@ -54,6 +55,12 @@ namespace casadi {
     /** \brief  destructor  */
     virtual ~SXNode();
 
+    ///@{
+    /** \brief  Allocate from the active node pool */
+    static void* operator new(std::size_t sz);
+    static void operator delete(void* ptr, std::size_t sz);
+    ///@}
+
     ///@{
     /** \brief  check properties of a node */
     virtual bool is_constant() const; // check if constant
@@ -128,6 +135,78 @@ namespace casadi {
 
   };
 
+  /** \brief Slab allocator for SXNode instances
+
+      Memory is requested in aligned slabs, each serving a single size class, and
+      freed nodes are kept in per-size-class free lists. The pool owning a node is
+      found from the header of the slab containing it. A pool may be used from several
+      threads, its free lists being guarded by a mutex, while the active pool is
+      selected per thread.
+  */
+  class CASADI_EXPORT SXNodePool {
+  public:
+    /// Constructor
+    SXNodePool();
+
+    /// Destructor, frees all the slabs
+    ~SXNodePool();
+
+    /// Allocate memory for a node
+    void* allocate(std::size_t sz);
+
+    /// Return memory to the pool that owns it
+    static void deallocate(void* ptr, std::size_t sz);
+
+    /// Delete the pool as soon as no nodes remain allocated in it
+    void release();
+
+    /// Number of nodes currently allocated
+    std::size_t n_alloc() const;
+
+    /// Pool that new nodes are allocated from in the calling thread
+    static SXNodePool* active();
+
+    /// Change the active pool of the calling thread, null means the shared pool
+    static void set_active(SXNodePool* pool);
+
+    /// Shared pool, used when no arena is active
+    static SXNodePool* shared();
+
+    /// Size of a slab, also its alignment
+    static const std::size_t slab_size = 1 << 16;
+
+    /// Granularity of the size classes
+    static const std::size_t granularity = 16;
+
+    /// Number of size classes, larger objects are allocated with operator new
+    static const std::size_t n_class = 8;
+
+  private:
+    // Header at the beginning of each slab
+    struct Slab {
+      SXNodePool* pool;
+      Slab* next;
+    };
+
+    // Get a new slab for a size class
+    void grow(std::size_t c);
+
+    // Free lists, one per size class
+    void* free_[n_class];
+
+    // Linked list of slabs
+    Slab* slabs_;
+
+    // Number of nodes allocated
+    std::size_t n_alloc_;
+
+    // Delete the pool when the last node is freed
+    bool released_;
+
+    // Guards the free lists and the counters
+    mutable std::mutex mtx_;
+  };
+
 } // namespace casadi
 /// \endcond
 #endif // CASADI_SX_NODE_HPP
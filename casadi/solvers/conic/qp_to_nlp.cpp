@@ -180,7 +180,8 @@ namespace casadi {
     res1[NLPSOL_LAM_G] = lam_a_;
 
     // Solve the NLP
-    solver_(arg1, res1, iw, w, 0);
+    ScopedCheckout solver_mem(solver_);
+    solver_(arg1, res1, iw, w, solver_mem);
   }
 
 } // namespace casadi
@@ -26,10 +26,23 @@
 #include "shell_compiler.hpp"
 #include "casadi/core/std_vector_tools.hpp"
 #include "casadi/core/casadi_meta.hpp"
+#include "casadi/core/global_options.hpp"
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
 #include <dlfcn.h>
 #include <cstdlib>
+#include <ctime>
 #include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#ifdef WITH_THREAD
+#include <thread>
+#include <atomic>
+#endif // WITH_THREAD
 
 using namespace std;
 namespace casadi {
@@ -52,12 +65,16 @@ namespace casadi {
   ShellCompiler::ShellCompiler(const std::string& name) :
     ImporterInternal(name) {
       handle_ = 0;
+      cached_ = false;
   }
 
   ShellCompiler::~ShellCompiler() {
     // Unload
     if (handle_) dlclose(handle_);
 
+    // Entries in the cache are kept
+    if (cached_ || bin_name_.empty()) return;
+
     // Delete the temporary file
     std::string rmcmd = "rm " + bin_name_;
     if (system(rmcmd.c_str())) {
@@ -77,7 +94,17 @@ namespace casadi {
         " custom flags."}},
       {"flags",
        {OT_STRINGVECTOR,
-      "Compile flags for the JIT compiler. Default: None"}}
+      "Compile flags for the JIT compiler. Default: None"}},
+      {"cache",
+       {OT_STRING,
+        "Directory of a persistent cache of compiled shared libraries, shared between "
+        "processes. Entries are keyed by a hash of the source code and the compiler command. "
+        "Default: GlobalOptions::jit_cache (empty, no caching)"}},
+      {"cache_size",
+       {OT_INT,
+        "Maximum size of the cache in megabytes, least recently used entries are "
+        "removed first. Temporary files older than a day, left behind by interrupted "
+        "compilations, are removed as well. Default: GlobalOptions::jit_cache_size"}}
      }
   };
 
@@ -89,6 +116,8 @@ namespace casadi {
     string compiler = "gcc";
     string compiler_setup = "-fPIC -shared";
     vector<string> flags;
+    string cache = GlobalOptions::jit_cache;
+    int cache_size = GlobalOptions::jit_cache_size;
 
     // Read options
     for (auto&& op : opts) {
@@ -98,6 +127,10 @@ namespace casadi {
         compiler_setup = op.second.to_string();
       } else if (op.first=="flags") {
         flags = op.second;
+      } else if (op.first=="cache") {
+        cache = op.second.to_string();
+      } else if (op.first=="cache_size") {
+        cache_size = op.second;
       }
     }
 
@@ -108,17 +141,57 @@ namespace casadi {
       cmd << " " << *i;
     }
 
+    // Additional source files, e.g. chunks of a split function, relative to the main file
+    vector<string> sources;
+    if (has_meta("sources")) {
+      string dir = name_.substr(0, name_.find_last_of('/')+1);
+      istringstream ss(get_meta("sources"));
+      string s;
+      while (ss >> s) sources.push_back(dir + s);
+    }
+
+    // Look up the cache, compile and insert on a miss
+    string cache_name;
+    if (!cache.empty()) {
+      // The source file names are not part of the key
+      cache_name = cache + "/" + cache_entry(cmd.str(), sources);
+      if (access(cache_name.c_str(), R_OK)==0) {
+        // Hit: mark as recently used and load
+        utime(cache_name.c_str(), 0);
+        bin_name_ = cache_name;
+        cached_ = true;
+        handle_ = dlopen(bin_name_.c_str(), RTLD_LAZY);
+        if (handle_) {
+          dlerror();
+          return;
+        }
+        // Unusable entry, replace it
+        dlerror();
+        cached_ = false;
+      }
+      // Only accessible to the user, since the entries are loaded as code
+      mkdir(cache.c_str(), 0700);
+    }
+
+    // Command without source and output files
+    string cmd_base = cmd.str();
+
     // C/C++ source file
     cmd << " " << name_;
 
     // Name of temporary file
 #ifdef HAVE_MKSTEMPS
-    // Preferred solution
-    char bin_name[] = "tmp_casadi_compiler_shell_XXXXXX.so";
-    if (mkstemps(bin_name, 3) == -1) {
+    // Preferred solution, in the cache directory if any so that it can be renamed into place
+    string bin_template = cache.empty() ? "tmp_casadi_compiler_shell_XXXXXX.so"
+      : cache + "/tmp_casadi_compiler_shell_XXXXXX.so";
+    vector<char> bin_name(bin_template.begin(), bin_template.end());
+    bin_name.push_back('\0');
+    int fd = mkstemps(&bin_name.front(), 3);
+    if (fd == -1) {
       casadi_error("Failed to create a temporary file name");
     }
-    bin_name_ = bin_name;
+    close(fd);
+    bin_name_ = &bin_name.front();
 #else
     // Fallback, may result in deprecation warnings
     char* bin_name = tempnam(0, "ca.so");
@@ -131,14 +204,29 @@ namespace casadi {
       bin_name_ = "./" + bin_name_;
     }
 
+    // Compile additional source files in parallel and link them
+    vector<string> objects = compile_sources(cmd_base, sources);
+    for (auto&& o : objects) cmd << " " << o;
+
     // Temporary file
     cmd << " -o " << bin_name_;
 
     // Compile into a shared library
-    if (system(cmd.str().c_str())) {
+    int flag = system(cmd.str().c_str());
+    for (auto&& o : objects) remove(o.c_str());
+    if (flag) {
+      remove(bin_name_.c_str());
+      bin_name_.clear();
       casadi_error("Compilation failed. Tried \"" + cmd.str() + "\"");
     }
 
+    // Move into the cache atomically, concurrent writers produce identical entries
+    if (!cache_name.empty() && rename(bin_name_.c_str(), cache_name.c_str())==0) {
+      bin_name_ = cache_name;
+      cached_ = true;
+      prune_cache(cache, cache_size, cache_name);
+    }
+
     // Load shared library
     handle_ = dlopen(bin_name_.c_str(), RTLD_LAZY);
     casadi_assert_message(handle_!=0, "CommonExternal: Cannot open function: "
@@ -147,6 +235,121 @@ namespace casadi {
     dlerror();
   }
 
+  std::vector<std::string>
+  ShellCompiler::compile_sources(const std::string& cmd_base,
+                                 const std::vector<std::string>& sources) {
+    // Object files next to the shared library
+    vector<string> objects(sources.size()), cmd(sources.size());
+    string base = bin_name_.substr(0, bin_name_.size()-3);
+    for (int k=0; k<sources.size(); ++k) {
+      objects[k] = base + "_" + CodeGenerator::to_string(k) + ".o";
+      cmd[k] = cmd_base + " -c " + sources[k] + " -o " + objects[k];
+    }
+
+    // Run the compiler, one process per hardware thread
+    vector<int> flag(sources.size(), 0);
+#ifdef WITH_THREAD
+    int n_threads = std::min(static_cast<int>(sources.size()),
+                             max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    std::atomic<int> next(0);
+    vector<std::thread> threads;
+    for (int t=0; t<n_threads; ++t) {
+      threads.push_back(std::thread([&]() {
+        while (true) {
+          int k = next++;
+          if (k>=sources.size()) break;
+          flag[k] = system(cmd[k].c_str());
+        }
+      }));
+    }
+    for (auto&& t : threads) t.join();
+#else // WITH_THREAD
+    for (int k=0; k<sources.size(); ++k) flag[k] = system(cmd[k].c_str());
+#endif // WITH_THREAD
+
+    // Check for errors
+    for (int k=0; k<sources.size(); ++k) {
+      if (flag[k]) {
+        for (auto&& o : objects) remove(o.c_str());
+        remove(bin_name_.c_str());
+        bin_name_.clear();
+        casadi_error("Compilation failed. Tried \"" + cmd[k] + "\"");
+      }
+    }
+    return objects;
+  }
+
+  std::string ShellCompiler::cache_entry(const std::string& cmd,
+                                         const std::vector<std::string>& sources) const {
+    // Hashed: CasADi version, compiler command and source code
+    stringstream src;
+    src << CasadiMeta::getVersion() << '\0' << cmd;
+    vector<string> files(1, name_);
+    files.insert(files.end(), sources.begin(), sources.end());
+    for (int k=0; k<files.size(); ++k) {
+      ifstream file(files[k].c_str(), ios::binary);
+      casadi_assert_message(file.good(), "Cannot open \"" + files[k] + "\"");
+      stringstream content;
+      content << file.rdbuf();
+      string c = content.str();
+      if (k==0) {
+        // The names of the additional sources are temporary, their contents are hashed instead
+        size_t pos = c.find("\n:sources");
+        if (pos!=string::npos) c.erase(pos, c.find('\n', pos+1) - pos);
+      }
+      src << '\0' << c;
+    }
+    string s = src.str();
+
+    // 128-bit key from two 64-bit hashes: FNV-1a and djb2
+    unsigned long long h1 = 14695981039346656037ULL, h2 = 5381;
+    for (unsigned char c : s) {
+      h1 = (h1 ^ c) * 1099511628211ULL;
+      h2 = (h2 << 5) + h2 + c;
+    }
+    stringstream ss;
+    ss << "casadi_jit_" << hex << setfill('0') << setw(16) << h1 << setw(16) << h2 << ".so";
+    return ss.str();
+  }
+
+  void ShellCompiler::prune_cache(const std::string& cache, int cache_size,
+                                  const std::string& keep) {
+    DIR* dir = opendir(cache.c_str());
+    if (!dir) return;
+
+    // Collect the entries: modification time, size, path
+    vector<pair<time_t, pair<off_t, string> > > entries;
+    off_t total = 0;
+    time_t now = time(0);
+    while (dirent* e = readdir(dir)) {
+      string fname = e->d_name;
+      bool is_tmp = fname.compare(0, 26, "tmp_casadi_compiler_shell_")==0;
+      if (!is_tmp && fname.compare(0, 11, "casadi_jit_")!=0) continue;
+      string path = cache + "/" + fname;
+      struct stat st;
+      if (stat(path.c_str(), &st)) continue;
+      if (is_tmp) {
+        // Temporary files left behind by interrupted compilations, those of compilations
+        // still in progress are more recent
+        if (now - st.st_mtime > 24*3600) remove(path.c_str());
+        continue;
+      }
+      total += st.st_size;
+      if (path!=keep) entries.push_back(make_pair(st.st_mtime, make_pair(st.st_size, path)));
+    }
+    closedir(dir);
+
+    // Remove least recently used entries until within bounds
+    off_t max_size = static_cast<off_t>(cache_size) * 1024 * 1024;
+    sort(entries.begin(), entries.end());
+    for (auto&& e : entries) {
+      if (total <= max_size) break;
+      // Failure is fine, e.g. removed by another process
+      remove(e.second.second.c_str());
+      total -= e.second.first;
+    }
+  }
+
   signal_t ShellCompiler::get_function(const std::string& symname) {
     signal_t ret;
     ret = reinterpret_cast<signal_t>(dlsym(handle_, symname.c_str()));
@@ -78,9 +78,25 @@ namespace casadi {
     /// Get a function pointer for numerical evaluation
     virtual signal_t get_function(const std::string& symname);
   protected:
-    /// Temporary file
+    /// Name of the cache entry for a compiler command and the source code
+    std::string cache_entry(const std::string& cmd,
+                            const std::vector<std::string>& sources) const;
+
+    /// Compile additional source files to object files, in parallel
+    std::vector<std::string> compile_sources(const std::string& cmd_base,
+                                             const std::vector<std::string>& sources);
+
+    /// Remove least recently used cache entries exceeding the size bound,
+    /// and temporary files of interrupted compilations
+    static void prune_cache(const std::string& cache, int cache_size,
+                            const std::string& keep);
+
+    /// Temporary file or cache entry
     std::string bin_name_;
 
+    /// Is bin_name_ a cache entry (and must not be deleted)
+    bool cached_;
+
     // Shared library handle
     typedef void* handle_t;
     handle_t handle_;
@@ -333,4 +333,24 @@ namespace casadi {
     }
   }
 
+  void Collocation::codegen_reset(CodeGenerator& g, const std::string& Z,
+                                  const std::string& x, const std::string& z) const {
+    // Initial guess for Z, cf. reset
+    for (int d=0; d<deg_; ++d) {
+      int off = d*(nx_+nz_);
+      g.body << "  " << g.copy(x, nx_, Z + "+" + g.to_string(off)) << endl
+             << "  " << g.copy(z, nz_, Z + "+" + g.to_string(off+nx_)) << endl;
+    }
+  }
+
+  void Collocation::codegen_resetB(CodeGenerator& g, const std::string& RZ,
+                                   const std::string& rx, const std::string& rz) const {
+    // Initial guess for RZ, cf. resetB
+    for (int d=0; d<deg_; ++d) {
+      int off = d*(nrx_+nrz_);
+      g.body << "  " << g.copy(rx, nrx_, RZ + "+" + g.to_string(off)) << endl
+             << "  " << g.copy(rz, nrz_, RZ + "+" + g.to_string(off+nrx_)) << endl;
+    }
+  }
+
 } // namespace casadi
@@ -100,69 +100,10 @@ namespace casadi {
     // Get sparsity
     Sparsity s = Sparsity::compressed(m->sparsity);
 
-    // Symbolic expression for A
-    SX A = SX::sym("A", s);
-
-    // BTF factorization
-    const Sparsity::Btf& btf = s.btf();
-
-    // Get the inverted column permutation
-    std::vector<int> inv_colperm(btf.colperm.size());
-    for (int k=0; k<btf.colperm.size(); ++k)
-      inv_colperm[btf.colperm[k]] = k;
-
-    // Get the inverted row permutation
-    std::vector<int> inv_rowperm(btf.rowperm.size());
-    for (int k=0; k<btf.rowperm.size(); ++k)
-      inv_rowperm[btf.rowperm[k]] = k;
-
-    // Permute the linear system
-    SX Aperm = A(btf.rowperm, btf.colperm);
-
-    // Generate the QR factorization function
-    SX Q1, R1;
-    qr(Aperm, Q1, R1);
-    m->factorize = Function("QR_fact", {A}, {Q1, R1}, fopts_);
+    // Create the factorization and solve functions
+    LinsolInternal::qr_functions(s, m->factorize, m->solve, m->solveT, fopts_);
     m->alloc(m->factorize);
-
-    // Symbolic expressions for solve function
-    SX Q = SX::sym("Q", Q1.sparsity());
-    SX R = SX::sym("R", R1.sparsity());
-    SX b = SX::sym("b", s.size2(), 1);
-
-    // Solve non-transposed
-    // We have Pb' * Q * R * Px * x = b <=> x = Px' * inv(R) * Q' * Pb * b
-
-    // Permute the right hand sides
-    SX bperm = b(btf.rowperm, Slice());
-
-    // Solve the factorized system
-    SX xperm = SX::solve(R, mtimes(Q.T(), bperm));
-
-    // Permute back the solution
-    SX x = xperm(inv_colperm, Slice());
-
-    // Generate the QR solve function
-    vector<SX> solv_in = {Q, R, b};
-    m->solve = Function("QR_solv", solv_in, {x}, fopts_);
     m->alloc(m->solve);
-
-    // Solve transposed
-    // We have (Pb' * Q * R * Px)' * x = b
-    // <=> Px' * R' * Q' * Pb * x = b
-    // <=> x = Pb' * Q * inv(R') * Px * b
-
-    // Permute the right hand side
-    bperm = b(btf.colperm, Slice());
-
-    // Solve the factorized system
-    xperm = mtimes(Q, SX::solve(R.T(), bperm));
-
-    // Permute back the solution
-    x = xperm(inv_rowperm, Slice());
-
-    // Mofify the QR solve function
-    m->solveT = Function("QR_solv_T", solv_in, {x}, fopts_);
     m->alloc(m->solveT);
 
     // Temporary storage
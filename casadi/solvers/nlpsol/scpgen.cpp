@@ -1196,7 +1196,8 @@ namespace casadi {
     m->res[CONIC_LAM_A] = m->dlam_gk; // Multipliers (linear bounds)
 
     // Solve the QP
-    qpsol_(m->arg, m->res, m->iw, m->w, 0);
+    ScopedCheckout qpsol_mem(qpsol_);
+    qpsol_(m->arg, m->res, m->iw, m->w, qpsol_mem);
 
     // Calculate penalty parameter of merit function
     m->sigma = merit_start_;
@@ -808,7 +808,8 @@ namespace casadi {
     m->res[CONIC_LAM_A] = lambda_A_opt;
 
     // Solve the QP
-    qpsol_(m->arg, m->res, m->iw, m->w, 0);
+    ScopedCheckout qpsol_mem(qpsol_);
+    qpsol_(m->arg, m->res, m->iw, m->w, qpsol_mem);
   }
 
   double Sqpmethod::
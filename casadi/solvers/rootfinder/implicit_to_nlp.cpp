@@ -172,7 +172,8 @@ namespace casadi {
     m->res[NLPSOL_X] = m->x;
 
     // Solve the NLP
-    solver_(m->arg, m->res, m->iw, m->w, 0);
+    ScopedCheckout solver_mem(solver_);
+    solver_(m->arg, m->res, m->iw, m->w, solver_mem);
     m->solver_stats = solver_.stats();
 
     // Get the implicit variable
@@ -24,6 +24,7 @@
 
 
 #include "newton.hpp"
+#include "casadi/core/function/linsol_internal.hpp"
 #include <iomanip>
 
 using namespace std;
@@ -119,6 +120,10 @@ namespace casadi {
     // Get the initial guess
     casadi_copy(m->iarg[iin_], n_, m->x);
 
+    // Linear solver memory, not shared with concurrent calls
+    ScopedCheckout linsol_mem(linsol_.operator->());
+    linsol_.reset(sp_jac_, linsol_mem);
+
     // Perform the Newton iterations
     m->iter=0;
     bool success = true;
@@ -155,8 +160,8 @@ namespace casadi {
       }
 
       // Factorize the linear solver with J
-      linsol_.factorize(m->jac);
-      linsol_.solve(m->f, 1, false);
+      linsol_.factorize(m->jac, linsol_mem);
+      linsol_.solve(m->f, 1, false, linsol_mem);
 
       // Check convergence again
       double abstolStep=0;
@@ -193,6 +198,65 @@ namespace casadi {
     casadi_msg("Newton::solveNonLinear():end after " << m->iter << " steps");
   }
 
+  void Newton::generateDeclarations(CodeGenerator& g) const {
+    get_function("jac_f_z")->addDependency(g);
+    linsol_->codegen_declarations(g, sp_jac_);
+  }
+
+  void Newton::generateBody(CodeGenerator& g) const {
+    const Function& jac = get_function("jac_f_z");
+    casadi_assert_message(!g.simplifiedCall(jac), "Not implemented.");
+    string n = g.to_string(n_);
+
+    // Work vectors, cf. set_work
+    g.body << "  int i, iter;" << endl
+           << "  real_t *x=w, *f=w+" << n_ << ", *jac=w+" << 2*n_ << ";" << endl
+           << "  const real_t** arg1 = arg + " << n_in() << ";" << endl
+           << "  real_t** res1 = res + " << n_out() << ";" << endl;
+
+    // Get the initial guess
+    g.body << "  " << g.copy("arg[" + g.to_string(iin_) + "]", n_, "x") << endl;
+
+    // Perform the Newton iterations
+    g.body << "  for (iter=0; iter<" << max_iter_ << "; ++iter) {" << endl;
+
+    // Use x to evaluate J
+    g.body << "    for (i=0; i<" << n_in() << "; ++i) arg1[i] = arg[i];" << endl
+           << "    arg1[" << iin_ << "] = x;" << endl
+           << "    res1[0] = jac;" << endl
+           << "    for (i=0; i<" << n_out() << "; ++i) res1[1+i] = res[i];" << endl
+           << "    res1[" << (1+iout_) << "] = f;" << endl
+           << "    if (" << g(jac, "arg1", "res1", "iw", "w+" + g.to_string(2*n_+sp_jac_.nnz()))
+           << ") return 1;" << endl;
+
+    // Check convergence
+    if (abstol_ != numeric_limits<double>::infinity()) {
+      g.addInclude("math.h");
+      g.addAuxiliary(CodeGenerator::AUX_NORM_INF);
+      g.body << "    if (norm_inf(" << n << ", f) <= " << g.constant(abstol_)
+             << ") break;" << endl;
+    }
+
+    // Solve the linear system with J
+    linsol_->codegen_solve(g, sp_jac_, "jac", {"f"}, {1}, {false});
+
+    // Check convergence again
+    if (abstolStep_ != numeric_limits<double>::infinity()) {
+      g.addInclude("math.h");
+      g.addAuxiliary(CodeGenerator::AUX_NORM_INF);
+      g.body << "    if (norm_inf(" << n << ", f) <= " << g.constant(abstolStep_)
+             << ") break;" << endl;
+    }
+
+    // Update Xk+1 = Xk - J^(-1) F
+    g.addAuxiliary(CodeGenerator::AUX_AXPY);
+    g.body << "    axpy(" << n << ", -1., f, x);" << endl
+           << "  }" << endl;
+
+    // Get the solution
+    g.body << "  " << g.copy("x", n_, "res[" + g.to_string(iout_) + "]") << endl;
+  }
+
   void Newton::printIteration(std::ostream &stream) const {
     stream << setw(5) << "iter";
     stream << setw(10) << "res";
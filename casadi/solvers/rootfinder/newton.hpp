@@ -102,6 +102,15 @@ namespace casadi {
     /// Solve the system of equations and calculate derivatives
     virtual void solve(void* mem) const;
 
+    /** \brief Is codegen supported? */
+    virtual bool has_codegen() const { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    virtual void generateDeclarations(CodeGenerator& g) const;
+
+    /** \brief Generate code for the body of the C function */
+    virtual void generateBody(CodeGenerator& g) const;
+
     /// A documentation string
     static const std::string meta_doc;
 
@@ -0,0 +1,166 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/** \brief Concurrent evaluation of one Function instance
+ * NOTE: Example is mainly intended for developers of CasADi.
+ * A rootfinder, which holds a linear solver with memory of its own, is evaluated
+ * from several threads, each with a memory object checked out from the pool.
+ * Linear systems are factorized concurrently in different memory objects of one
+ * linear solver instance. The results must agree with a serial evaluation.
+ */
+
+#include "casadi/casadi.hpp"
+#include <thread>
+
+using namespace casadi;
+using namespace std;
+
+// Largest deviation between two vectors
+double max_err(const vector<double>& a, const vector<double>& b) {
+  double err = 0;
+  for (int k=0; k<a.size(); ++k) err = max(err, fabs(a[k]-b[k]));
+  return err;
+}
+
+// Memory objects are reused after release, and new ones are created on demand
+int check_pool(const Function& f) {
+  int m1 = f.checkout();
+  int m2 = f.checkout();
+  f.release(m1);
+  int m3 = f.checkout();
+  int m4 = f.checkout();
+  f.release(m2);
+  f.release(m3);
+  f.release(m4);
+  bool ok = m1!=m2 && m3==m1 && m4!=m1 && m4!=m2;
+  cout << f.name() << ": memory objects " << m1 << ", " << m2 << ", " << m3 << ", " << m4
+       << (ok ? "" : " (wrong)") << endl;
+  return !ok;
+}
+
+// Evaluate f from several threads, returns the number of failures
+int check_function(Function f, int n_thread) {
+  // Parameter values and serial reference solutions
+  vector<vector<double> > p(n_thread), x(n_thread), x_ref(n_thread);
+  for (int t=0; t<n_thread; ++t) {
+    p[t] = {0.1*(t+1), 0.2*(t+1)};
+    x_ref[t] = f(vector<DM>{DM::zeros(2), DM(p[t])}).at(0).nonzeros();
+  }
+
+  // Concurrent evaluation, each thread with work vectors and memory of its own
+  vector<thread> threads;
+  for (int t=0; t<n_thread; ++t) {
+    threads.emplace_back([&, t]() {
+      vector<const double*> arg(f.sz_arg());
+      vector<double*> res(f.sz_res());
+      vector<int> iw(f.sz_iw());
+      vector<double> w(f.sz_w());
+      vector<double> x0(2, 0);
+      x[t].resize(2);
+      for (int rep=0; rep<100; ++rep) {
+        arg[0] = get_ptr(x0);
+        arg[1] = get_ptr(p[t]);
+        res[0] = get_ptr(x[t]);
+        ScopedCheckout mem(f);
+        f(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w), mem);
+      }
+    });
+  }
+  for (auto&& th : threads) th.join();
+
+  double err = 0;
+  for (int t=0; t<n_thread; ++t) err = max(err, max_err(x[t], x_ref[t]));
+  cout << f.name() << ": max error " << err << " with " << n_thread << " threads" << endl;
+  return err>1e-12;
+}
+
+// Factorize different matrices concurrently with one linear solver instance
+int check_linsol(const Linsol& F, int n_thread) {
+  // Positive definite test matrices
+  DM A = DM::eye(4) + 0.1*DM::ones(4, 4);
+  vector<double> err(n_thread, 0);
+  vector<thread> threads;
+  for (int t=0; t<n_thread; ++t) {
+    threads.emplace_back([&, t]() {
+      DM At = (t+1)*A;
+      DM b = DM::ones(4);
+      int mem = F.checkout();
+      F.reset(At.sparsity(), mem);
+      for (int rep=0; rep<100; ++rep) {
+        F.factorize(At.ptr(), mem);
+        DM x = b;
+        F.solve(x.ptr(), 1, false, mem);
+        DM r = mtimes(At, x) - b;
+        for (int k=0; k<r.nnz(); ++k) err[t] = max(err[t], fabs(r.ptr()[k]));
+      }
+      F.release(mem);
+    });
+  }
+  for (auto&& th : threads) th.join();
+  double e = *max_element(err.begin(), err.end());
+  cout << F.plugin_name() << ": max residual " << e << " with " << n_thread << " threads" << endl;
+  return e>1e-12;
+}
+
+int main(){
+  if (!has_linsol("csparse")) {
+    cout << "csparse not available" << endl;
+    return 0;
+  }
+
+  // Rootfinding problem parametrized by p
+  SX x = SX::sym("x", 2);
+  SX p = SX::sym("p", 2);
+  SX r = vertcat(x(0) + 0.1*pow(x(0), 3) - p(0), x(1) + x(0)*x(1) - p(1));
+  Function g("g", {x, p}, {r});
+  Function f = rootfinder("f", "newton", g, {{"linear_solver", "csparse"}});
+
+  Linsol F("F", "csparse");
+  int n_fail = check_pool(f) + check_function(f, 4) + check_linsol(F, 4);
+
+  // Cholesky factors are kept per memory object
+  if (has_linsol("csparsecholesky")) {
+    Linsol C("C", "csparsecholesky");
+    DM A = DM::eye(3) + 0.1*DM::ones(3, 3);
+    DM B = 2*A;
+    int m1 = C.checkout(), m2 = C.checkout();
+    C.reset(A.sparsity(), m1);
+    C.factorize(A.ptr(), m1);
+    C.reset(B.sparsity(), m2);
+    C.factorize(B.ptr(), m2);
+    DM L1 = C.cholesky(false, m1), L2 = C.cholesky(false, m2);
+    C.release(m1);
+    C.release(m2);
+    double err = static_cast<double>(norm_inf(sqrt(2)*L1 - L2));
+    cout << "csparsecholesky: max error " << err << " in separate memory objects" << endl;
+    n_fail += err>1e-12;
+  }
+
+  if (n_fail>0) {
+    cout << n_fail << " check(s) failed" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+
+/** \brief Repeated evaluation through a FunctionBuffer
+ * NOTE: Example is mainly intended for developers of CasADi.
+ * The global allocation operators are replaced to count heap allocations.
+ * Evaluating an SX and an MX function many times through a FunctionBuffer
+ * must not allocate, and must give the same result as the DM syntax.
+ */
+
+#include "casadi/casadi.hpp"
+#include <cstdlib>
+#include <new>
+
+using namespace casadi;
+using namespace std;
+
+// Number of heap allocations so far
+static size_t n_alloc = 0;
+
+void* operator new(size_t sz) {
+  ++n_alloc;
+  void* p = malloc(sz ? sz : 1);
+  if (!p) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+// Evaluate f repeatedly, returns the number of failures
+int check(Function f, const vector<DM>& arg) {
+  FunctionBuffer buf(f);
+  for (int i=0; i<f.n_in(); ++i) {
+    copy(arg[i].ptr(), arg[i].ptr()+arg[i].nnz(), buf.input(i));
+  }
+
+  // Reference solution
+  vector<DM> res = f(arg);
+
+  // Repeated evaluation
+  size_t n_alloc0 = n_alloc;
+  for (int k=0; k<10000; ++k) buf.eval();
+  size_t n_eval_alloc = n_alloc - n_alloc0;
+  cout << f.name() << ": " << n_eval_alloc << " allocations in 10000 evaluations" << endl;
+
+  // Compare
+  double err = 0;
+  for (int i=0; i<f.n_out(); ++i) {
+    for (int k=0; k<res[i].nnz(); ++k) {
+      err = max(err, fabs(res[i].ptr()[k] - buf.output(i)[k]));
+    }
+  }
+  cout << f.name() << ": max error " << err << endl;
+  return n_eval_alloc>0 || err>1e-12;
+}
+
+int main(){
+  // Small model, e.g. from a controller
+  SX x = SX::sym("x", 4);
+  SX u = SX::sym("u", 2);
+  SX ode = vertcat(x(1), -sin(x(0)) + u(0), x(3), -x(2) + u(1)*x(0));
+  Function f("f", {x, u}, {ode, dot(x, x)});
+
+  // An MX function with calls, products and nonzero mappings
+  MX X = MX::sym("X", 4);
+  MX U = MX::sym("U", 2);
+  MX K = MX::sym("K", 2, 4);
+  MX xk = X;
+  for (int k=0; k<4; ++k) {
+    vector<MX> fk = f(vector<MX>{xk, U - mtimes(K, xk)});
+    xk = xk + 0.1*fk[0];
+  }
+  Function g("g", {X, U, K}, {xk, xk(Slice(0, 2)), xk.T()});
+
+  vector<DM> x0 = {DM(vector<double>{0.1, 0.2, 0.3, 0.4}), DM(vector<double>{1, -1})};
+  DM K0 = DM::reshape(DM(vector<double>{0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8}), 2, 4);
+  int n_fail = check(f, x0) + check(g, {x0[0], x0[1], K0});
+  if (n_fail>0) {
+    cout << n_fail << " check(s) failed" << endl;
+    return 1;
+  }
+  return 0;
+}
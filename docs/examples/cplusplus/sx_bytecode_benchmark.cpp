@@ -0,0 +1,107 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/** \brief Throughput of the SXFunction virtual machine
+ * NOTE: Example is mainly intended for developers of CasADi.
+ * This example compares the numerical evaluation of a large SX function using
+ * the default switch-based virtual machine with the pre-decoded bytecode
+ * (option "bytecode"), which uses direct-threaded dispatch and superinstructions.
+ */
+
+#include "casadi/casadi.hpp"
+#include <chrono>
+
+using namespace casadi;
+using namespace std;
+
+int main(int argc, char* argv[]){
+  // Problem size
+  int n = argc>1 ? atoi(argv[1]) : 100000;
+
+  // A long chain of mostly arithmetic operations, e.g. from a discretized model
+  SX x = SX::sym("x", 10);
+  SX p = SX::sym("p", 10);
+  vector<SX> r;
+  SX s = 0;
+  for (int k=0; k<n; ++k) {
+    int i = k % 10, j = (3*k+1) % 10;
+    s = s + 0.5*x(i)*p(j) - x(j)/(1+p(i)*p(i));
+    if (k % 1000 == 999) {
+      s = sin(s);
+      r.push_back(s);
+    }
+  }
+  SX f_out = vertcat(r);
+
+  // Random-ish numerical inputs
+  vector<double> x_val(10), p_val(10), f_val(f_out.nnz());
+  for (int i=0; i<10; ++i) {
+    x_val[i] = 0.1*(i+1);
+    p_val[i] = 1.0/(i+1);
+  }
+
+  // Reference result
+  vector<double> f_ref;
+
+  for (bool bytecode : {false, true}) {
+    Function f("f", {x, p}, {f_out}, {{"bytecode", bytecode}});
+
+    // Work vectors
+    size_t sz_arg, sz_res, sz_iw, sz_w;
+    f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+    vector<const double*> arg(sz_arg);
+    vector<double*> res(sz_res);
+    vector<int> iw(sz_iw);
+    vector<double> w(sz_w);
+    arg[0] = get_ptr(x_val);
+    arg[1] = get_ptr(p_val);
+    res[0] = get_ptr(f_val);
+
+    // Evaluate repeatedly
+    int n_eval = 100;
+    auto t0 = chrono::steady_clock::now();
+    for (int k=0; k<n_eval; ++k) {
+      f(get_ptr(arg), get_ptr(res), get_ptr(iw), get_ptr(w));
+    }
+    auto t1 = chrono::steady_clock::now();
+    double t = chrono::duration<double>(t1-t0).count();
+
+    // Check consistency
+    if (bytecode) {
+      double err = 0;
+      for (int i=0; i<f_val.size(); ++i) err = max(err, fabs(f_val[i]-f_ref[i]));
+      cout << "max deviation from switch-based evaluation: " << err << endl;
+    } else {
+      f_ref = f_val;
+    }
+
+    cout << (bytecode ? "bytecode: " : "switch:   ")
+         << f.getAlgorithmSize() << " operations, "
+         << 1e3*t/n_eval << " ms per call, "
+         << 1e-6*n_eval*f.getAlgorithmSize()/t << " million operations per second" << endl;
+  }
+
+  return 0;
+}
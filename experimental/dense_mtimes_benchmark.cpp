@@ -0,0 +1,89 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** \brief Compare the reference and BLAS kernels for dense matrix products
+ *
+ * Times DM products and the covariance propagation P+ = A*P*A' + Q through an
+ * MXFunction for increasing dimensions, once with BLAS disabled
+ * (GlobalOptions::blas_threshold<0) and once with BLAS for all sizes.
+ * Without BLAS support (WITH_BLAS), both columns use the reference kernel.
+ */
+
+#include <casadi/casadi.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace casadi;
+using namespace std;
+
+// Dense n-by-n matrix with random entries
+DM dense_rand(int n) {
+  vector<double> v(n*n);
+  for (auto&& e : v) e = rand() / static_cast<double>(RAND_MAX);
+  return DM(Sparsity::dense(n, n), v);
+}
+
+// Average time in seconds for one call to fcn
+template<typename F>
+double timeit(F fcn) {
+  int n_rep = 0;
+  auto t0 = chrono::steady_clock::now();
+  double t;
+  do {
+    fcn();
+    n_rep++;
+    t = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  } while (t < 0.2);
+  return t / n_rep;
+}
+
+int main() {
+  cout << setw(6) << "n" << setw(16) << "DM ref [ms]" << setw(16) << "DM blas [ms]"
+       << setw(16) << "MX ref [ms]" << setw(16) << "MX blas [ms]" << endl;
+  for (int n : {10, 20, 50, 100, 200, 400}) {
+    // Dense data
+    DM A = dense_rand(n), P = dense_rand(n), Q = dense_rand(n);
+
+    // Covariance propagation
+    MX As = MX::sym("A", n, n), Ps = MX::sym("P", n, n), Qs = MX::sym("Q", n, n);
+    Function f("f", {As, Ps, Qs}, {mtimes(As, mtimes(Ps, As.T())) + Qs});
+    vector<DM> arg = {A, P, Q};
+
+    double t[2][2];
+    for (int blas=0; blas<2; ++blas) {
+      GlobalOptions::setBlasThreshold(blas ? 0 : -1);
+      t[blas][0] = timeit([&]() { DM r = mtimes(A, P);});
+      t[blas][1] = timeit([&]() { vector<DM> r = f(arg);});
+    }
+    GlobalOptions::setBlasThreshold(4096);
+
+    cout << setw(6) << n << fixed << setprecision(4)
+         << setw(16) << 1e3*t[0][0] << setw(16) << 1e3*t[1][0]
+         << setw(16) << 1e3*t[0][1] << setw(16) << 1e3*t[1][1] << endl;
+  }
+  return 0;
+}
@@ -3273,6 +3273,30 @@ DECL M casadi_eig_symbolic(const M& m) {
   return eig_symbolic(m);
 }
 
+DECL M casadi_cse(const M& e) {
+  return cse(e);
+}
+
+DECL std::vector< M > casadi_cse(const std::vector< M >& e) {
+  return cse(e);
+}
+
+DECL M casadi_reorder_mtimes(const M& e) {
+  return reorder_mtimes(e);
+}
+
+DECL std::vector< M > casadi_reorder_mtimes(const std::vector< M >& e) {
+  return reorder_mtimes(e);
+}
+
+DECL M casadi_merge_solves(const M& e) {
+  return merge_solves(e);
+}
+
+DECL std::vector< M > casadi_merge_solves(const std::vector< M >& e) {
+  return merge_solves(e);
+}
+
 #endif
 %enddef
 
@@ -3315,6 +3339,14 @@ casadi_graph_substitute(const std::vector< M > &ex,
   return graph_substitute(ex, v, vdef);
 }
 
+DECL M casadi_cse(const M& e) {
+  return cse(e);
+}
+
+DECL std::vector< M > casadi_cse(const std::vector< M >& e) {
+  return cse(e);
+}
+
 #endif
 %enddef
 
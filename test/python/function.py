@@ -25,6 +25,10 @@ from casadi import *
 import casadi as c
 import numpy
 import unittest
+import os
+import shutil
+import tempfile
+import time
 from types import *
 from helpers import *
 
@@ -485,7 +489,7 @@ class Functiontests(casadiTestCase):
     Z = [MX.sym("z",2,2) for i in range(n)]
     V = [MX.sym("z",Sparsity.upper(3)) for i in range(n)]
 
-    for parallelization in ["serial","openmp","unroll"] if args.run_slow else ["serial"]:
+    for parallelization in ["serial","openmp","unroll","simd"] if args.run_slow else ["serial","simd"]:
         print(parallelization)
         res = fun.map(n, parallelization).call([horzcat(*x) for x in [X,Y,Z,V]])
 
@@ -509,6 +513,50 @@ class Functiontests(casadiTestCase):
 
           self.checkfunction(f,Fref,inputs=X_+Y_+Z_+V_,sparsity_mod=args.run_slow)
 
+  def test_map_simd(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    f = Function("f",[x,y],[sin(x)*y+x**2, y[0]*y[1]])
+
+    for n in [1,3,4,9]:
+      F = f.map("F","simd",n)
+      Fref = f.map("Fref","serial",n)
+      X = DM(np.random.random((1,n)))
+      Y = DM(np.random.random((2,n)))
+      for r, rref in zip(F(X,Y),Fref(X,Y)):
+        self.checkarray(r,rref)
+      if n>1:
+        self.assertTrue(F.stats()["simd"])
+
+    # Non-SX inner functions fall back to serial evaluation
+    x = MX.sym("x")
+    g = Function("g",[x],[sin(x)])
+    G = g.map("G","simd",5)
+    X = DM(np.random.random((1,5)))
+    self.checkarray(G(X),sin(X))
+    self.assertFalse(G.stats()["simd"])
+
+  @requiresPlugin(Importer,"shell")
+  def test_map_batch(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    f = Function("f",[x,y],[sin(x)*y+x**2, y[0]*y[1]])
+
+    # Work space for the batched variant is only reserved on request
+    self.assertEqual(f.map("F","serial",130).sz_w(),f.sz_w())
+
+    # Generated code calls the batched variant of f, in blocks of instances
+    for n in [1,70,130]:
+      F = f.map("F","serial",n,{"codegen_batch":True, "jit":True, "compiler":"shell",
+                                "jit_codegen_options":{"batch":True}})
+      self.assertTrue(F.sz_w()>f.sz_w())
+      Fref = f.map("Fref","serial",n)
+      X = DM(np.random.random((1,n)))
+      Y = DM(np.random.random((2,n)))
+      for r, rref in zip(F(X,Y),Fref(X,Y)):
+        self.checkarray(r,rref)
+      self.check_codegen(F,inputs=[X,Y])
+
   @memory_heavy()
   def test_mapsum(self):
     x = SX.sym("x")
@@ -848,6 +896,56 @@ class Functiontests(casadiTestCase):
   #   [v] = f([])
   #   self.checkarray(2.37683, v, digits=4)
 
+  @requiresPlugin(Importer,"shell")
+  def test_jit_cache(self):
+    x = SX.sym("x",2)
+    d = tempfile.mkdtemp()
+    opts = {"jit":True, "compiler":"shell", "jit_options":{"cache":d}}
+    try:
+      f = Function("f",[x],[sin(x)*x[0]],opts)
+      self.assertEqual(len(os.listdir(d)),1)
+      entry = os.path.join(d,os.listdir(d)[0])
+      st = os.stat(entry)
+      # Same source and command: loaded from the cache, a recompilation would rename a new
+      # file over the entry. A hit only touches the modification time
+      g = Function("f",[x],[sin(x)*x[0]],opts)
+      self.assertEqual(os.listdir(d),[os.path.basename(entry)])
+      self.assertEqual(os.stat(entry).st_ino,st.st_ino)
+      self.checkarray(f([1,2]),g([1,2]))
+      self.checkarray(f([1,2]),sin(DM([1,2])))
+      # Size bound of zero keeps only the newest entry
+      opts["jit_options"]["cache_size"] = 0
+      h = Function("f",[x],[cos(x)],opts)
+      self.assertEqual(len(os.listdir(d)),1)
+      self.checkarray(h([1,2]),cos(DM([1,2])))
+    finally:
+      shutil.rmtree(d)
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_async(self):
+    x = SX.sym("x",2)
+    f = Function("f",[x],[sin(x)*x[0]],{"jit":True, "compiler":"shell", "jit_async":True})
+    self.assertTrue(f.stats()["jit_status"] in ["compiling","ready"])
+    # Evaluates while compiling
+    self.checkarray(f([1,2]),sin(DM([1,2])))
+    while f.stats()["jit_status"]=="compiling":
+      time.sleep(0.01)
+    self.assertEqual(f.stats()["jit_status"],"ready")
+    self.assertTrue(f.stats()["jit_t_switch"]>0)
+    self.checkarray(f([1,2]),sin(DM([1,2])))
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_split(self):
+    x = SX.sym("x",3)
+    y = x
+    for i in range(50):
+      y = sin(y)*y[i%3] + 0.1*y
+    f = Function("f",[x],[y])
+    for split in [False, True]:
+      g = Function("f",[x],[y],{"jit":True, "compiler":"shell",
+        "jit_codegen_options":{"max_chunk":20, "split_files":split}})
+      self.checkarray(f([1,2,3]),g([1,2,3]))
+
   def test_depends_on(self):
     x = SX.sym("x")
     y = x**2
@@ -281,6 +281,22 @@ class ImplicitFunctiontests(casadiTestCase):
     a = SX.sym("a",2)
     f = Function("f", [x,a],[tan(x)-a,sqrt(a)*x**2 ])
 
+  def test_codegen(self):
+    x = SX.sym("x",2)
+    a = SX.sym("a",2)
+    f = Function("f", [x,a],[vertcat(tan(x[0])-a[0],x[1]+x[1]**3-x[0]*a[1]),sqrt(a[0])*x[0]**2])
+
+    # Generated code solves the linear systems with a symbolic QR, whatever the linear solver
+    for linear_solver in ["csparse","symbolicqr"]:
+      solver=rootfinder("solver", "newton", f, {"linear_solver": linear_solver})
+      for F in [solver, solver.forward(2), solver.reverse(1)]:
+        inputs = [DM(F.sparsity_in(i),0.1*(i+1)) for i in range(F.n_in())]
+        arg = F.mx_in()
+        G = Function("G", arg, F.call(arg), {"jit":True, "compiler":"shell"})
+        for r, rref in zip(G.call(inputs),F.call(inputs)):
+          self.checkarray(r,rref,digits=10)
+        self.check_codegen(F,inputs=inputs)
+
 if __name__ == '__main__':
     unittest.main()
 
@@ -998,6 +998,36 @@ class Integrationtests(casadiTestCase):
 
     integrator_out = integrator(**integrator_in)
 
+  def test_codegen(self):
+    t=SX.sym("t")
+    x=SX.sym("x",2)
+    z=SX.sym("z")
+    p=SX.sym("p",2)
+    ode = {'t':t,'x':x,'p':p,'ode':vertcat(x[1]*p[0],-x[0]+sin(t)*p[1]),'quad':x[0]**2}
+    dae = {'t':t,'x':x,'z':z,'p':p,'ode':vertcat(x[1]*p[0],-x[0]+sin(t)*z),
+           'alg':z+0.1*z**3-0.5*x[0]**2-p[1],'quad':x[0]**2+z}
+
+    for Solver, prob, options in [("rk",ode,{"number_of_finite_elements": 7}),
+                                  ("collocation",dae,{"number_of_finite_elements": 5})]:
+      self.message(Solver)
+      I = integrator("I",Solver,prob,dict(options,grid=[0,0.3,0.7,1],output_t0=True,codegen=True))
+      Fs = [I]
+
+      # Derivatives, the reverse mode ones include the backward problem
+      I = integrator("I",Solver,prob,dict(options,tf=0.8,codegen=True))
+      Fs += [I.forward(2), I.reverse(1)]
+
+      # Work space for generated code is only reserved on request
+      self.assertTrue(integrator("I",Solver,prob,dict(options,tf=0.8)).sz_w()<I.sz_w())
+
+      for F in Fs:
+        inputs = [DM(F.sparsity_in(i),0.1*(i+1)) for i in range(F.n_in())]
+        arg = F.mx_in()
+        G = Function("G", arg, F.call(arg), {"jit":True, "compiler":"shell"})
+        for r, rref in zip(G.call(inputs),F.call(inputs)):
+          self.checkarray(r,rref,digits=10)
+        self.check_codegen(F,inputs=inputs)
+
   def test_collocationPoints(self):
     self.message("collocation points")
     with self.assertRaises(Exception):
@@ -522,6 +522,44 @@ class LinearSolverTests(casadiTestCase):
         
       with self.assertRaises(Exception):
         solve(As,bs,Solver,options)
-        
+
+  def test_merge_solves(self):
+    n = 4
+    A_ = DM(numpy.random.rand(n,n))+n*DM.eye(n)
+    b_ = DM(numpy.random.rand(n))
+    c_ = DM(numpy.random.rand(n,2))
+    A = MX.sym("A",n,n)
+    b = MX.sym("b",n)
+    c = MX.sym("c",n,2)
+    for Solver, options, req in lsolvers:
+      if "symmetry" in req: continue
+      solver = casadi.Linsol("solver", Solver, options)
+      x = solver.solve(A,b)
+      y = solver.solve(A,c,True)
+      z = solver.solve(A,x)
+      e = [x,y,z,mtimes(inv(A),b)]
+      e_ref = [x,y,z,mtimes(solver.solve(A,MX.eye(n)),b)]
+
+      # z depends on x and needs a second factorization, shared with the inverse
+      r = merge_solves(e)
+      self.assertTrue(r[0].dep().is_op(OP_SOLVE))
+      self.assertTrue(is_equal(r[0].dep(),r[1].dep()))
+      self.assertTrue(is_equal(r[2].dep(),r[3].dep(1).dep()))
+      self.assertFalse(is_equal(r[0].dep(),r[2].dep()))
+
+      # Solves merged before join a batch with all their right-hand-sides
+      w = solver.solve(A,c)
+      r2 = merge_solves([r[0],r[1],w])
+      self.assertTrue(is_equal(r2[0].dep(),r2[2].dep()))
+      self.assertTrue(r2[0].dep().n_dep()==4)
+      g = Function("g",[A,b,c],r2)
+      g_ref = Function("g",[A,b,c],[x,y,w])
+      self.checkfunction(g,g_ref,inputs=[A_,b_,c_])
+
+      # Derivatives are generated with merged solves as well
+      f = Function("f",[A,b,c],e,{"merge_solves":True})
+      f_ref = Function("f",[A,b,c],e_ref)
+      self.checkfunction(f,f_ref,inputs=[A_,b_,c_])
+
 if __name__ == '__main__':
     unittest.main()
@@ -994,5 +994,22 @@ class Matrixtests(casadiTestCase):
     a = DM([DM([1]),DM([2])])
     self.checkarray(a,DM([1,2]))
 
+  def test_blas_threshold(self):
+    t = GlobalOptions.getBlasThreshold()
+    for (m,k,n) in [(30,40,50),(30,40,1),(1,40,50)]:
+      x = DM(numpy.random.rand(m,k))
+      y = DM(numpy.random.rand(k,n))
+      z = DM(numpy.random.rand(m,n))
+      X = MX.sym("x",m,k)
+      Y = MX.sym("y",k,n)
+      f = Function("f",[X,Y],[mtimes(X,Y)])
+      try:
+        GlobalOptions.setBlasThreshold(0)
+        r = [mac(x,y,z),f(x,y)]
+      finally:
+        GlobalOptions.setBlasThreshold(t)
+      self.checkarray(r[0],numpy.dot(x.full(),y.full())+z.full())
+      self.checkarray(r[1],numpy.dot(x.full(),y.full()))
+
 if __name__ == '__main__':
     unittest.main()
@@ -2425,5 +2425,147 @@ class MXtests(casadiTestCase):
 
         self.checkfunction(f,fr,inputs=[0])
 
+  def test_execution_plan(self):
+    x = MX.sym("x",4,3)
+    y = MX.sym("y",3)
+    x2 = MX(x)
+    x2[1,2] = y[0]
+    x2[:3,0] = sin(y)
+    inner = Function("inner",[y],[sin(y),2*y])
+    [a,b] = inner(y)
+    for opts in [{}, {"live_variables":False}]:
+      f = Function("f",[x,y],[reshape(x,3,4),x[[0,5,5,11]],x2,x,b,a+b,b],opts)
+      self.checkfunction(f,f.expand(),inputs=[DM(f.sparsity_in(i),numpy.random.rand(f.nnz_in(i))) for i in range(2)])
+
+  def test_parallelization(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    step = Function("step",[x,p],[x+0.1*vertcat(x[1],-p*sin(x[0]))])
+    x0 = MX.sym("x0",2)
+    P = MX.sym("p",5)
+    xk = [step(x0*(i+1),P[i]) for i in range(5)]
+    out = [horzcat(*xk),sum([dot(e,e) for e in xk]),x0]
+    f = Function("f",[x0,P],out)
+    fp = Function("f",[x0,P],out,{"parallelization":"openmp"})
+    self.checkfunction(fp,f,inputs=[DM([0.1,0.2]),DM([1,2,3,4,5])])
+    with self.assertRaises(Exception):
+      Function("f",[x0,P],out,{"parallelization":"foo"})
+
+  def test_views(self):
+    x = MX.sym("x",12)
+    y = MX.sym("y",3)
+    z = sin(x)
+    zs = z[2:8]
+    [a,b,c] = vertsplit(x,[0,4,5,12])
+    out = [z.T(),mtimes(reshape(zs,2,3),y),2*z,zs,sin(a)+x[:4],b*y[0],mtimes(reshape(c,1,7),reshape(c,7,1))]
+    for opts in [{}, {"live_variables":False}]:
+      f = Function("f",[x,y],out,opts)
+      self.checkfunction(f,f.expand(),inputs=[DM(f.sparsity_in(i),numpy.random.rand(f.nnz_in(i))) for i in range(2)])
+    # The transpose, slice and reshape share storage with sin(x)
+    f = Function("f",[x,y],[z.T(),reshape(z[2:8],2,3)])
+    self.assertTrue(f.sz_w()<=12+6)
+
+  def test_gather_fusion(self):
+    x = MX.sym("x",6)
+    A = MX.sym("A",3,3)
+    xv = DM(numpy.random.rand(6))
+    Av = DM(numpy.random.rand(3,3))
+    def ops(x,A):
+      z = type(x).zeros(5,1)
+      z[[1,3]] = x[[0,2]]
+      w = type(x).zeros(6,1)
+      w[:] = x[[5,4,3,2,1,0]]
+      return [vertcat(x[0],x[3],x[1]),reshape(x,2,3)[:,1],A.T()[:2,:],z,w,
+              horzcat(A[:,2],A[:,0]),vertcat(x[:3],x[4:])[[4,0,3]],vertcat(x[:2],A[:2,0])]
+    r = ops(x,A)
+    # All but the last expression are single gathers from the symbolic input
+    for e in r[:-1]:
+      self.assertTrue(e.is_op(OP_GETNONZEROS))
+      self.assertTrue(e.dep().is_symbolic())
+    f = Function("f",[x,A],r)
+    for i,e in enumerate(ops(xv,Av)):
+      self.checkarray(f(xv,Av)[i],e)
+
+  def test_cse(self):
+    x = MX.sym("x",3)
+    A = MX.sym("A",3,3)
+    xs = SX.sym("x",3)
+    g = Function("g",[xs],[sin(xs),2*xs])
+    [a1,a2] = g(x)
+    [b1,b2] = g(x)
+    s1 = solve(A,a1,"csparse")
+    s2 = solve(A,b1,"csparse")
+    e = [mtimes(A,a1)+mtimes(A,b1),s1*s2+b2]
+
+    r = cse(e)
+    self.assertTrue(n_nodes(r[0])<n_nodes(e[0]))
+    self.assertTrue(n_nodes(r[1])<n_nodes(e[1]))
+
+    f = Function("f",[x,A],e)
+    fc = Function("f",[x,A],e,{"cse":True})
+    self.assertTrue(fc.n_nodes()<f.n_nodes())
+    self.checkfunction(fc,f,inputs=[DM([0.1,0.2,0.3]),DM([[3,1,0],[1,4,2],[0,1,5]])])
+
+  def test_cse_solve(self):
+    A = MX.sym("A",3,3)
+    b = MX.sym("b",3)
+    # Independent calls create separate linear solver instances
+    x1 = solve(A,b,"csparse")
+    x2 = solve(A,b,"csparse")
+    self.assertTrue(is_equal(x1,x2,1))
+    self.assertFalse(is_equal(x1,solve(A,b,"csparse",{"verbose":True}),1))
+    if Linsol.has_plugin("symbolicqr"):
+      self.assertFalse(is_equal(x1,solve(A,b,"symbolicqr"),1))
+
+    r = cse([x1,x2])
+    self.assertTrue(is_equal(r[0],r[1]))
+
+    f = Function("f",[A,b],[x1+x2])
+    fc = Function("f",[A,b],[x1+x2],{"cse":True})
+    self.assertTrue(fc.n_nodes()<f.n_nodes())
+    self.checkfunction(fc,f,inputs=[DM([[3,1,0],[1,4,2],[0,1,5]]),DM([0.1,0.2,0.3])])
+
+  def test_reorder_mtimes(self):
+    n = 6
+    A = MX.sym("A",n,n)
+    B = MX.sym("B",n,n)
+    x = MX.sym("x",n)
+    AB = mtimes(A,B)
+    e = [mtimes(AB,x),mtimes(mtimes(x.T(),A),mtimes(B,x))]
+
+    # The matrix-matrix product is avoided
+    r = reorder_mtimes(e[0])
+    self.assertTrue(r.is_op(OP_MTIMES))
+    self.assertTrue(r.dep(2).is_op(OP_MTIMES))
+    self.assertTrue(r.dep(2).dep(1).is_symbolic())
+    self.assertTrue(reorder_mtimes(mtimes([A,B,x])).dep(2).is_op(OP_MTIMES))
+
+    # mtimes on a list multiplies from left to right
+    self.assertTrue(mtimes([A,B,x]).dep(1).is_op(OP_MTIMES))
+
+    # A product that is used elsewhere is kept
+    r = reorder_mtimes(mtimes(AB,x)+sum1(AB).T())
+    self.assertTrue(n_nodes(r)==n_nodes(mtimes(AB,x)+sum1(AB).T()))
+
+    f = Function("f",[A,B,x],e)
+    fr = Function("f",[A,B,x],e,{"reorder_mtimes":True})
+    self.checkfunction(fr,f,inputs=[DM(numpy.random.rand(n,n)),DM(numpy.random.rand(n,n)),DM(numpy.random.rand(n))])
+
+  def test_mtimes_scalar_chain(self):
+    A = MX.sym("A",3,4)
+    s = MX.sym("s")
+    B = MX.sym("B",4,5)
+    x = MX.sym("x",5)
+    for args in [[A,s,B],[A,2*s,B,x],[s,A,B,x],[A,B,x,s]]:
+      left = args[0]
+      for a in args[1:]: left = mtimes(left,a)
+      e = mtimes(args)
+      f = Function("f",[A,s,B,x],[left])
+      for opts in [{},{"reorder_mtimes":True}]:
+        fr = Function("f",[A,s,B,x],[e],opts)
+        self.checkfunction(fr,f,inputs=[DM(numpy.random.rand(3,4)),DM(0.7),DM(numpy.random.rand(4,5)),DM(numpy.random.rand(5))])
+      fr = Function("f",[A,s,B,x],[reorder_mtimes(e)])
+      self.checkfunction(fr,f,inputs=[DM(numpy.random.rand(3,4)),DM(0.7),DM(numpy.random.rand(4,5)),DM(numpy.random.rand(5))])
+
 if __name__ == '__main__':
     unittest.main()
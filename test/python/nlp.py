@@ -85,6 +85,51 @@ class NLPtests(casadiTestCase):
       solver_out = solver(**solver_in)
       self.assertAlmostEqual(solver_out["x"][0],6*pi,6,str(Solver))
 
+  def test_numeric_gradient(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp={'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2}
+
+    for Solver, solver_options in solvers:
+      solver_options = dict(solver_options)
+      solver_options["numeric_gradient"] = True
+      solver = nlpsol("mysolver", Solver, nlp, solver_options)
+      solver_out = solver(x0=[-1.2,1])
+      self.checkarray(solver_out["x"],DM([1,1]),str(Solver),digits=5)
+
+  def test_numeric_hessian(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp={'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2, 'g':x*y+sin(x)}
+
+    for Solver, solver_options in solvers:
+      solver_options = dict(solver_options)
+      solver_options["numeric_hessian"] = True
+      solver = nlpsol("mysolver", Solver, nlp, solver_options)
+      solver_out = solver(x0=[-1.2,1],lbg=-10,ubg=10)
+      self.checkarray(solver_out["x"],DM([1,1]),str(Solver),digits=5)
+
+  def test_numeric_hessian_sqpmethod(self):
+    x=SX.sym("x")
+    y=SX.sym("y")
+    nlp={'x':vertcat(x,y), 'f':(1-x)**2+100*(y-x**2)**2, 'g':x*y+sin(x)}
+
+    for Solver, solver_options in solvers:
+      if Solver!="sqpmethod" or "limited-memory" in str(solver_options): continue
+      ref = nlpsol("mysolver", Solver, nlp, solver_options)
+      solver_options = dict(solver_options)
+      solver_options["numeric_hessian"] = True
+      solver = nlpsol("mysolver", Solver, nlp, solver_options)
+
+      # sqpmethod requests sym:hess:gamma:x:x, calculated by edge pushing
+      hess_l = solver.get_function("nlp_hess_l")
+      self.assertTrue(hess_l.is_a("mxfunction"))
+      arg = [DM([-1.2,1]), DM(), DM(0.7), DM(1.3)]
+      self.checkarray(hess_l(*arg),ref.get_function("nlp_hess_l")(*arg))
+
+      solver_out = solver(x0=[-1.2,1],lbg=-10,ubg=10)
+      self.checkarray(solver_out["x"],DM([1,1]),str(Solver),digits=5)
+
   def testboundsviol(self):
     x=SX.sym("x")
     nlp={'x':x, 'f':(x-1)**2, 'g':x}
@@ -26,6 +26,9 @@ import casadi as c
 import numpy
 from numpy import random, array, linalg, matrix, zeros, ones
 import unittest
+import os
+import shutil
+import tempfile
 from types import *
 from helpers import *
 from casadi import *
@@ -1300,5 +1303,164 @@ class SXtests(casadiTestCase):
       self.checkfunction(f,fa,inputs=[3])
       self.checkfunction(f,fb,inputs=[-3],evals=1)
 
+  def test_bytecode(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    e = vertcat(x[0]*x[1]+x[2], 3*x[0], x[1]-p[0], x[2]/p[1], sin(x[0])*p[0]+p[1], -x[1]**2)
+
+    f = Function("f",[x,p],[e,x[0]*p[1]])
+    fb = Function("f",[x,p],[e,x[0]*p[1]],{"bytecode":True})
+
+    self.checkfunction(fb,f,inputs=[[1.1,2.3,0.7],[0.3,1.9]])
+
+  def test_cse(self):
+    x = SX.sym("x",3)
+    a = sin(x[0])*x[1]+cos(x[2])
+    b = x[1]*sin(x[0])+cos(x[2])
+    e = vertcat(a*b, (2.5+a)-(2.5+b), sin(x[0])*x[1])
+
+    r = cse(e)
+    self.assertTrue(n_nodes(r)<n_nodes(e))
+    self.assertTrue(r.sparsity()==e.sparsity())
+
+    f = Function("f",[x],[e])
+    fc = Function("f",[x],[e],{"cse":True})
+    self.assertTrue(fc.getAlgorithmSize()<f.getAlgorithmSize())
+    self.checkfunction(fc,f,inputs=[[1.1,2.3,0.7]])
+
+  def test_arena_outlive(self):
+    n0 = SXArena.n_pools()
+    a = SXArena()
+    x = SX.sym("x",2)
+    e = sin(x[0])*x[1]+x[0]**2
+    self.assertTrue(a.n_nodes()>0)
+    self.assertEqual(SXArena.n_pools(),n0+1)
+    del a
+    # Nodes created in the arena remain valid after it has gone out of scope
+    self.assertEqual(SXArena.n_pools(),n0+1)
+    f = Function("f",[x],[e])
+    self.checkarray(f([0.3,2])[0],sin(0.3)*2+0.3**2)
+
+    # The memory is released with the last node
+    del f, e, x
+    self.assertEqual(SXArena.n_pools(),n0)
+
+  def test_arena_empty(self):
+    n0 = SXArena.n_pools()
+    a = SXArena()
+    self.assertEqual(a.n_nodes(),0)
+    del a
+    self.assertEqual(SXArena.n_pools(),n0)
+
+  def test_numeric_forward(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    e = vertcat(x[0]*x[1]+x[2], sin(x[0])*p[0], x[2]/p[1], sqrt(x[1])+exp(-x[0]), atan2(x[0],p[0]))
+
+    f = Function("f",[x,p],[e,x[0]*p[1]])
+    fn = Function("f",[x,p],[e,x[0]*p[1]],{"numeric_forward":True})
+
+    self.checkfunction(fn,f,inputs=[[1.1,2.3,0.7],[0.3,1.9]])
+    for nfwd in [1,3]:
+      self.assertTrue(fn.forward_new(nfwd).is_a("sxforward"))
+      self.checkfunction(fn.forward_new(nfwd),f.forward_new(nfwd),
+        inputs=[[1.1,2.3,0.7],[0.3,1.9],DM(5,1),DM(1,1),DM.ones(3,nfwd),DM.ones(2,nfwd)*0.7])
+
+  def test_numeric_reverse(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p",2)
+    e = vertcat(x[0]*x[1]+x[2], sin(x[0])*p[0], x[2]/p[1], sqrt(x[1])+exp(-x[0]), atan2(x[0],p[0]))
+
+    f = Function("f",[x,p],[e,x[0]*p[1]])
+    fn = Function("f",[x,p],[e,x[0]*p[1]],{"numeric_reverse":True})
+
+    self.checkfunction(fn,f,inputs=[[1.1,2.3,0.7],[0.3,1.9]])
+    for nadj in [1,3]:
+      self.assertTrue(fn.reverse_new(nadj).is_a("sxreverse"))
+      self.checkfunction(fn.reverse_new(nadj),f.reverse_new(nadj),
+        inputs=[[1.1,2.3,0.7],[0.3,1.9],DM(5,1),DM(1,1),DM.ones(5,nadj),DM.ones(1,nadj)*0.7])
+
+  def test_hessian_edge_pushing(self):
+    x = SX.sym("x",4)
+    p = SX.sym("p",2)
+    f = (1-x[0])**2+100*(x[1]-x[0]**2)**2 + p[0]*sin(x[1]*x[2]) + exp(x[2]/(p[1]+2)) \
+        + sqrt(x[0]**2+1)*x[3]**3 + atan2(x[3],x[1]) + x[3]*x[3]/x[0]
+    g = Function("g",[x,p],[f],["x","p"],["f"])
+
+    h = g.factory("h",["x","p"],["hess:f:x:x"])
+    he = g.factory("he",["x","p"],["hess:f:x:x"],{},{"hessian_edge_pushing":True})
+    self.assertTrue(he.sparsity_out(0).is_triu())
+    self.checkfunction(he,h,inputs=[[0.3,0.7,-0.2,1.1],[0.4,0.9]],hessian=False)
+
+  def test_sparsity_width(self):
+    n = 700
+    x = SX.sym("x",n)
+    e = vertcat(*[sin(x[i]*x[(i+1)%n])+x[(7*i+3)%n]**2 for i in range(n)])
+    J = jacobian(e,x).sparsity()
+    H = hessian(dot(e,e),x)[0].sparsity()
+    for w in [64,256,320]:
+      f = Function("f",[x],[e],{"sparsity_width":w})
+      self.assertTrue(f.sparsity_jac(0,0)==J)
+      fr = Function("f",[x],[e],{"sparsity_width":w,"ad_weight_sp":1})
+      self.assertTrue(fr.sparsity_jac(0,0)==J)
+      g = Function("g",[x],[gradient(dot(e,e),x)],{"sparsity_width":w})
+      self.assertTrue(g.sparsity_jac(0,0,False,True)==H)
+    GlobalOptions.setHierarchicalSparsity(False)
+    try:
+      sp = [Function("f",[x],[e],{"sparsity_width":w}).sparsity_jac(0,0) for w in [64,256]]
+    finally:
+      GlobalOptions.setHierarchicalSparsity(True)
+    for s in sp:
+      self.assertTrue(s==J)
+    with self.assertRaises(Exception):
+      Function("f",[x],[e],{"sparsity_width":100})
+
+  def test_sparsity_parallel(self):
+    n = 700
+    x = SX.sym("x",n)
+    e = vertcat(*[sin(x[i]*x[(i+1)%n])+x[(7*i+3)%n]**2 for i in range(n)])
+    g = gradient(dot(e,e),x)
+    xm = MX.sym("x",n)
+    for hierarchical in [True,False]:
+      GlobalOptions.setHierarchicalSparsity(hierarchical)
+      try:
+        # The sweeps of an SXFunction are made in parallel (if compiled with OpenMP),
+        # those of the wrapping MXFunction serially
+        for w in [64,256]:
+          for opts in [{},{"ad_weight_sp":1}]:
+            f = Function("f",[x],[e],dict(opts,sparsity_width=w))
+            fm = Function("fm",[xm],[f(xm)],opts)
+            self.assertTrue(f.sparsity_jac(0,0)==fm.sparsity_jac(0,0))
+          f = Function("f",[x],[g],{"sparsity_width":w})
+          fm = Function("fm",[xm],[f(xm)])
+          self.assertTrue(f.sparsity_jac(0,0,False,True)==fm.sparsity_jac(0,0,False,True))
+      finally:
+        GlobalOptions.setHierarchicalSparsity(True)
+
+  def test_sparsity_cache(self):
+    n = 700
+    x = SX.sym("x",n)
+    e = vertcat(*[sin(x[i]*x[(i+1)%n])+x[(7*i+3)%n]**2 for i in range(n)])
+    d = tempfile.mkdtemp()
+    GlobalOptions.setSparsityCache(d)
+    try:
+      sp = Function("f",[x],[e]).sparsity_jac(0,0)
+      self.assertTrue(len(os.listdir(d))>0)
+      entries = {f: os.stat(os.path.join(d,f)).st_ino for f in os.listdir(d)}
+      # A structurally identical function is served from the cache, a miss would write
+      # new entries or rename new files over the existing ones
+      sp2 = Function("g",[x],[e]).sparsity_jac(0,0)
+      self.assertEqual({f: os.stat(os.path.join(d,f)).st_ino for f in os.listdir(d)},entries)
+      H = Function("h",[x],[dot(e,e)]).hessian(0,0)
+      H2 = Function("h",[x],[dot(e,e)]).hessian(0,0)
+    finally:
+      GlobalOptions.setSparsityCache("")
+      shutil.rmtree(d)
+    self.assertTrue(sp==sp2)
+    self.assertTrue(sp==jacobian(e,x).sparsity())
+    self.assertTrue(H.sparsity_out(0)==H2.sparsity_out(0))
+    x0 = DM(list(range(n)))/n
+    self.checkarray(H(x0)[0],H2(x0)[0])
+
 if __name__ == '__main__':
     unittest.main()